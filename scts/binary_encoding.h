@@ -0,0 +1,283 @@
+#pragma once
+
+#include <string>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+
+#include "stream.h"
+#include "value_as_binary.h"
+
+namespace scts {
+	struct invalid_varint : std::exception {
+		invalid_varint(std::size_t position) : m_String("Invalid varint at position " + std::to_string(position)) { }
+		const char* what() const noexcept override { return m_String.c_str(); }
+	private:
+		const std::string m_String;
+	};
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	inline constexpr bool host_is_little_endian = false;
+#else
+	// All the targets of MSVC are little endian.
+	inline constexpr bool host_is_little_endian = true;
+#endif
+
+	template <typename U>
+	constexpr U byte_swap(U value) noexcept {
+		static_assert(std::is_unsigned_v<U>);
+		U swapped = 0;
+		for (std::size_t i = 0; i < sizeof(U); ++i) {
+			swapped = static_cast<U>((swapped << 8) | (value & 0xff));
+			value = static_cast<U>(value >> 8);
+		}
+		return swapped;
+	}
+
+	template <std::size_t Size> struct unsigned_of_size;
+	template <> struct unsigned_of_size<1> { using type = std::uint8_t; };
+	template <> struct unsigned_of_size<2> { using type = std::uint16_t; };
+	template <> struct unsigned_of_size<4> { using type = std::uint32_t; };
+	template <> struct unsigned_of_size<8> { using type = std::uint64_t; };
+
+	// Converts between host order and little endian order, which is the same in both directions.
+	// On little endian hosts this does nothing.
+	template <typename T>
+	T to_little_endian(T value) noexcept {
+		if constexpr (host_is_little_endian || sizeof(T) == 1) {
+			return value;
+		}
+		else {
+			using unsigned_type = typename unsigned_of_size<sizeof(T)>::type;
+			unsigned_type bits;
+			std::memcpy(&bits, &value, sizeof(T));
+			bits = byte_swap(bits);
+			std::memcpy(&value, &bits, sizeof(T));
+			return value;
+		}
+	}
+
+	// Converts between host order and big endian order, as used by MessagePack and CBOR.
+	template <typename T>
+	T to_big_endian(T value) noexcept {
+		if constexpr (!host_is_little_endian || sizeof(T) == 1) {
+			return value;
+		}
+		else {
+			using unsigned_type = typename unsigned_of_size<sizeof(T)>::type;
+			unsigned_type bits;
+			std::memcpy(&bits, &value, sizeof(T));
+			bits = byte_swap(bits);
+			std::memcpy(&value, &bits, sizeof(T));
+			return value;
+		}
+	}
+
+	// Swaps the byte order of count values of Size bytes each. Written as a plain loop over fixed size values,
+	// which compilers turn into vector shuffles.
+	template <std::size_t Size>
+	void byte_swap_values(char* bytes, std::size_t count) noexcept {
+		using unsigned_type = typename unsigned_of_size<Size>::type;
+		for (std::size_t i = 0; i < count; ++i) {
+			unsigned_type bits;
+			std::memcpy(&bits, bytes + i * Size, Size);
+			bits = byte_swap(bits);
+			std::memcpy(bytes + i * Size, &bits, Size);
+		}
+	}
+
+	// How the binary formatters store vectors of registered types: one object after another, or one member after another.
+	enum class binary_layout { rows, columns };
+
+	// Encodings decide how the binary formatters store numbers, enums and lengths.
+	// Everything else, such as the layout of containers and presence flags, is shared.
+	// Contiguous runs of values for which copies_as_bytes is true go through write_values and read_values.
+
+	// Numbers and enums are stored as their in-memory representation, lengths as 64-bit values.
+	struct fixed_width_encoding {
+		static constexpr bool copies_bulk_objects = true;
+
+		// Whether contiguous runs of T can be copied as a whole, instead of encoding each value.
+		template <typename T>
+		static constexpr bool copies_as_bytes = is_bulk_copyable_v<T>;
+
+		template <typename T>
+		static void write(T value, scts::out_stream& stream) {
+			scts::value_as_binary(value).write(stream);
+		}
+
+		template <typename T>
+		static T read(scts::in_stream& stream) {
+			return scts::value_as_binary<T>(stream).value();
+		}
+
+		static void write_length(std::size_t length, scts::out_stream& stream) {
+			write(static_cast<std::uint64_t>(length), stream);
+		}
+
+		static std::uint64_t read_length(scts::in_stream& stream) {
+			return read<std::uint64_t>(stream);
+		}
+
+		template <typename T>
+		static void write_values(const T* values, std::size_t count, scts::out_stream& stream) {
+			write_bulk(values, count, stream);
+		}
+
+		template <typename T>
+		static void read_values(T* values, std::size_t count, scts::in_stream& stream) {
+			read_bulk(values, count, stream);
+		}
+	};
+
+	// Like fixed_width_encoding, but always in little endian order, so that the output can be read on any host
+	// where the types have the same sizes. Values are only swapped on big endian hosts.
+	struct little_endian_encoding {
+		static constexpr bool copies_bulk_objects = host_is_little_endian;
+
+		// On big endian hosts only numbers and enums can be swapped in bulk, objects are swapped member by member.
+		template <typename T>
+		static constexpr bool copies_as_bytes = is_bulk_copyable_v<T> && (host_is_little_endian || std::is_arithmetic_v<T> || std::is_enum_v<T>);
+
+		template <typename T>
+		static void write(T value, scts::out_stream& stream) {
+			scts::value_as_binary(to_little_endian(value)).write(stream);
+		}
+
+		template <typename T>
+		static T read(scts::in_stream& stream) {
+			return to_little_endian(scts::value_as_binary<T>(stream).value());
+		}
+
+		static void write_length(std::size_t length, scts::out_stream& stream) {
+			write(static_cast<std::uint64_t>(length), stream);
+		}
+
+		static std::uint64_t read_length(scts::in_stream& stream) {
+			return read<std::uint64_t>(stream);
+		}
+
+		template <typename T>
+		static void write_values(const T* values, std::size_t count, scts::out_stream& stream) {
+			if constexpr (host_is_little_endian || sizeof(T) == 1) {
+				write_bulk(values, count, stream);
+			}
+			else {
+				const auto bytes = stream.prepare(count * sizeof(T));
+				if (count != 0) std::memcpy(bytes, values, count * sizeof(T));
+				byte_swap_values<sizeof(T)>(bytes, count);
+				stream.commit(count * sizeof(T));
+			}
+		}
+
+		template <typename T>
+		static void read_values(T* values, std::size_t count, scts::in_stream& stream) {
+			read_bulk(values, count, stream);
+			if constexpr (!host_is_little_endian && sizeof(T) != 1) {
+				byte_swap_values<sizeof(T)>(reinterpret_cast<char*>(values), count);
+			}
+		}
+	};
+
+	// Integers, enums and lengths are stored as LEB128 varints, seven bits per byte with the high bit marking that
+	// more bytes follow. Signed integers are zigzag encoded first, so that small negative values stay short too.
+	// Floating point numbers and single byte values are stored as they are, since a varint could only make them longer.
+	struct varint_encoding {
+		static constexpr bool copies_bulk_objects = false;
+		static constexpr std::size_t max_varint_size = 10;
+
+		template <typename T>
+		static constexpr bool copies_as_bytes = is_bulk_copyable_v<T> && (std::is_floating_point_v<T> || sizeof(T) == 1);
+
+		template <typename T>
+		static void write(T value, scts::out_stream& stream) {
+			if constexpr (std::is_enum_v<T>) {
+				write(static_cast<std::underlying_type_t<T>>(value), stream);
+			}
+			else if constexpr (std::is_floating_point_v<T> || sizeof(T) == 1) {
+				scts::value_as_binary(value).write(stream);
+			}
+			else if constexpr (std::is_signed_v<T>) {
+				write_varint(zigzag_encode(static_cast<std::int64_t>(value)), stream);
+			}
+			else {
+				write_varint(value, stream);
+			}
+		}
+
+		template <typename T>
+		static T read(scts::in_stream& stream) {
+			if constexpr (std::is_enum_v<T>) {
+				return static_cast<T>(read<std::underlying_type_t<T>>(stream));
+			}
+			else if constexpr (std::is_floating_point_v<T> || sizeof(T) == 1) {
+				return scts::value_as_binary<T>(stream).value();
+			}
+			else {
+				const auto position = stream.position();
+				const auto encoded = read_varint(stream);
+				if constexpr (std::is_signed_v<T>) {
+					const auto value = zigzag_decode(encoded);
+					if (value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max()) throw invalid_varint(position);
+					return static_cast<T>(value);
+				}
+				else {
+					if (encoded > std::numeric_limits<T>::max()) throw invalid_varint(position);
+					return static_cast<T>(encoded);
+				}
+			}
+		}
+
+		static void write_length(std::size_t length, scts::out_stream& stream) {
+			write_varint(length, stream);
+		}
+
+		static std::uint64_t read_length(scts::in_stream& stream) {
+			return read_varint(stream);
+		}
+
+		template <typename T>
+		static void write_values(const T* values, std::size_t count, scts::out_stream& stream) {
+			write_bulk(values, count, stream);
+		}
+
+		template <typename T>
+		static void read_values(T* values, std::size_t count, scts::in_stream& stream) {
+			read_bulk(values, count, stream);
+		}
+
+		static void write_varint(std::uint64_t value, scts::out_stream& stream) {
+			const auto begin = stream.prepare(max_varint_size);
+			auto current = begin;
+			while (value >= 0x80) {
+				*current++ = static_cast<char>(value | 0x80);
+				value >>= 7;
+			}
+			*current++ = static_cast<char>(value);
+			stream.commit(static_cast<std::size_t>(current - begin));
+		}
+
+		static std::uint64_t read_varint(scts::in_stream& stream) {
+			const auto position = stream.position();
+			std::uint64_t value = 0;
+			for (unsigned shift = 0; shift < 64; shift += 7) {
+				const auto byte = static_cast<std::uint8_t>(stream.get());
+				// The tenth byte may only hold the single remaining bit.
+				if (shift == 63 && byte > 1) throw invalid_varint(position);
+				value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+				if ((byte & 0x80) == 0) return value;
+			}
+			throw invalid_varint(position);
+		}
+
+		static constexpr std::uint64_t zigzag_encode(std::int64_t value) noexcept {
+			return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+		}
+
+		static constexpr std::int64_t zigzag_decode(std::uint64_t value) noexcept {
+			return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+		}
+	};
+}
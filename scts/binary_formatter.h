@@ -2,19 +2,42 @@
 
 #include "stream.h"
 #include "binary_writer.h"
+#include "binary_reader.h"
+#include "fingerprint.h"
+#include "binary_encoding.h"
 
 namespace scts {
-	struct binary_formatter : binary_writer {
+	template <typename Encoding, binary_layout Layout = binary_layout::rows>
+	struct basic_binary_formatter : basic_binary_writer<Encoding, Layout>, basic_binary_reader<Encoding, Layout> {
 		static constexpr bool requires_names = false;
+		static constexpr bool copies_bulk_objects = Encoding::copies_bulk_objects;
+		static constexpr bool checks_schema = true;
 
 		// We do not need to pre or post handle writing or reading.
 		static void prepare_read(scts::in_stream&) { }
 		static void prepare_write(scts::out_stream&) { }
 		static void post_write(scts::out_stream&) { }
-		// The formatter does not use separators.
-		static void write_inherited_object_separator(scts::out_stream&) { }
 
-		template <typename T>
-		static void read_member(T& member, scts::in_stream& stream) { }
+		// Every payload starts with the fingerprint of the descriptor of the written object, always as 8 little endian bytes.
+		// The columnar layout has its own fingerprints, so that it is never read as rows.
+		static void write_fingerprint(std::uint64_t fingerprint, scts::out_stream& stream) {
+			scts::value_as_binary(to_little_endian(layout_fingerprint(fingerprint))).write(stream);
+		}
+
+		static void check_fingerprint(std::uint64_t expected, scts::in_stream& stream) {
+			if (to_little_endian(scts::value_as_binary<std::uint64_t>(stream).value()) != layout_fingerprint(expected)) throw schema_mismatch();
+		}
+	private:
+		static constexpr std::uint64_t layout_fingerprint(std::uint64_t fingerprint) noexcept {
+			return Layout == binary_layout::columns ? combine_fingerprint(fingerprint, hash_name("columns")) : fingerprint;
+		}
 	};
+
+	using binary_formatter = basic_binary_formatter<fixed_width_encoding>;
+	// Stores integers, enums and lengths as varints, which makes the output much smaller when they are mostly small.
+	using compact_binary_formatter = basic_binary_formatter<varint_encoding>;
+	// Stores numbers in little endian order, so the output can be exchanged between hosts of any byte order.
+	using portable_binary_formatter = basic_binary_formatter<little_endian_encoding>;
+	// Stores vectors of registered types as a column for each member, which compresses better for large batches.
+	using columnar_binary_formatter = basic_binary_formatter<fixed_width_encoding, binary_layout::columns>;
 }
\ No newline at end of file
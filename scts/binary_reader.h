@@ -0,0 +1,249 @@
+#pragma once
+
+#include <bitset>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+#include "delta.h"
+#include "stream.h"
+#include "helpers.h"
+#include "builtin_types.h"
+#include "reader_helpers.h"
+#include "value_as_binary.h"
+#include "binary_encoding.h"
+
+namespace scts {
+	// Reads what basic_binary_writer wrote with the same Encoding and Layout, in a single forward pass over the stream.
+	template <typename Encoding, binary_layout Layout = binary_layout::rows>
+	struct basic_binary_reader {
+		static constexpr bool requires_names = false;
+		static constexpr bool copies_bulk_objects = Encoding::copies_bulk_objects;
+
+		template <typename T>
+		static void read_member(T& member, scts::in_stream& stream) {
+			read_value(member, stream);
+		}
+
+		template <typename O>
+		static void read_object_bytes(O& object, scts::in_stream& stream) {
+			read_bulk(std::addressof(object), 1, stream);
+		}
+
+		// Applies a delta written by basic_binary_writer::write_delta to the object it was computed against.
+		template <typename O>
+		static void read_delta(O& object, scts::in_stream& stream) {
+			using descriptor = std::decay_t<decltype(scts::register_type<O>::descriptor)>;
+			std::bitset<descriptor::member_count> changed;
+			read_bitmap(changed, changed.size(), stream);
+			std::size_t index = 0;
+			descriptor::for_each_member([&](auto member) {
+				using member_type = decltype(member);
+				if (changed[index++]) read_value_delta(member_type::get(object), stream);
+			});
+		}
+	private:
+		template <typename T>
+		static typename std::enable_if<is_builtin_type<T>::value, void>::type read_value(T& value, scts::in_stream& stream) {
+			builtin_type_reader<T>::read(value, stream);
+		}
+
+		template <typename T>
+		static typename std::enable_if<!is_builtin_type<T>::value, void>::type read_value(T& value, scts::in_stream& stream) {
+			basic_binary_reader reader;
+			scts::register_type<T>::descriptor.load(reader, value, stream);
+		}
+
+		template <typename T>
+		static void read_value_delta(T& value, scts::in_stream& stream) {
+			if constexpr (is_registered_type_v<T>) {
+				read_delta(value, stream);
+			}
+			else if constexpr (is_object_sequence_v<T> && object_sequence<T>::fixed_size) {
+				read_elements_delta(std::begin(value), std::size(value), stream);
+			}
+			else if constexpr (is_object_sequence_v<T>) {
+				if (read_bool(stream)) read_elements_delta(value.begin(), value.size(), stream);
+				else read_value(value, stream);
+			}
+			else if constexpr (std::is_pointer_v<T>) {
+				// The object already points to the pointee of the previous snapshot, so it is read over instead.
+				if (!read_bool(stream)) value = nullptr;
+				else read_value(scts::existing_or_allocated_pointee(value), stream);
+			}
+			else {
+				read_value(value, stream);
+			}
+		}
+
+		template <typename Iterator>
+		static void read_elements_delta(Iterator values, std::size_t count, scts::in_stream& stream) {
+			std::vector<bool> changed(count);
+			read_bitmap(changed, count, stream);
+			for (std::size_t i = 0; i < count; ++i) {
+				if (changed[i]) read_delta(values[i], stream);
+			}
+		}
+
+		static std::uint64_t read_length(scts::in_stream& stream) {
+			return Encoding::read_length(stream);
+		}
+
+		static bool read_bool(scts::in_stream& stream) {
+			// Read as a byte, as not every byte value is a valid bool.
+			return scts::value_as_binary<std::uint8_t>(stream).value() != 0;
+		}
+
+		template <typename Iterator>
+		static void read_values(Iterator begin, Iterator end, scts::in_stream& stream) {
+			for (auto current = begin; current != end; ++current) {
+				read_value(*current, stream);
+			}
+		}
+
+		// Reads the columns written by basic_binary_writer::write_columns into the already sized values.
+		template <typename T>
+		static void read_columns(std::vector<T>& values, scts::in_stream& stream) {
+			std::decay_t<decltype(scts::register_type<T>::descriptor)>::for_each_member([&](auto member) {
+				using member_type = decltype(member);
+				using value_type = typename member_type::value_type;
+				if constexpr (Encoding::template copies_as_bytes<value_type> && !std::is_array_v<value_type>) {
+					std::vector<value_type> column(values.size());
+					Encoding::read_values(column.data(), column.size(), stream);
+					for (std::size_t i = 0; i < values.size(); ++i) member_type::get(values[i]) = column[i];
+				}
+				else {
+					for (auto& value : values) read_value(member_type::get(value), stream);
+				}
+			});
+		}
+
+		// Strings and arithmetic types.
+		template <typename T, typename = void>
+		struct builtin_type_reader {
+			static void read(T& value, scts::in_stream& stream) {
+				if constexpr (std::is_same_v<T, std::string>) {
+					const auto length = read_length(stream);
+					if (length > stream.remaining()) throw unexpected_end_of_stream();
+					value = std::string(stream.read(static_cast<std::size_t>(length)));
+				}
+				else if constexpr (std::is_same_v<T, bool>) {
+					value = read_bool(stream);
+				}
+				else {
+					value = Encoding::template read<T>(stream);
+				}
+			}
+		};
+
+		// Enums.
+		template <typename Enum>
+		struct builtin_type_reader<Enum, std::enable_if_t<std::is_enum_v<Enum>>> {
+			static void read(Enum& value, scts::in_stream& stream) {
+				value = Encoding::template read<Enum>(stream);
+			}
+		};
+
+		// C-style pointers and arrays.
+		template <typename T>
+		struct builtin_type_reader<T*> {
+			static void read(T*& value, scts::in_stream& stream) {
+				if (!read_bool(stream)) {
+					value = nullptr;
+				}
+				else {
+					read_value(scts::allocate_pointee(value), stream);
+				}
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_reader<T[C]> {
+			static void read(T(&values)[C], scts::in_stream& stream) {
+				if constexpr (Encoding::template copies_as_bytes<T>) Encoding::read_values(values, C, stream);
+				else read_values(std::begin(values), std::end(values), stream);
+			}
+		};
+
+		// Standard library containers and classes.
+		template <typename T>
+		struct builtin_type_reader<std::vector<T>> {
+			static void read(std::vector<T>& values, scts::in_stream& stream) {
+				const auto length = read_length(stream);
+				values.clear();
+				if constexpr (Layout == binary_layout::columns && is_registered_type_v<T>) {
+					// Objects take up at least a byte each, unless they have no members at all.
+					constexpr bool has_members = std::decay_t<decltype(scts::register_type<T>::descriptor)>::member_count > 0;
+					if (has_members && length > stream.remaining()) throw unexpected_end_of_stream();
+					values.resize(static_cast<std::size_t>(length));
+					read_columns(values, stream);
+				}
+				else if constexpr (Encoding::template copies_as_bytes<T>) {
+					if (length > stream.remaining() / sizeof(T)) throw unexpected_end_of_stream();
+					values.resize(static_cast<std::size_t>(length));
+					Encoding::read_values(values.data(), values.size(), stream);
+				}
+				else {
+					values.reserve(reader_helpers::plausible_length(length, stream));
+					for (std::uint64_t i = 0; i < length; ++i) {
+						T value{};
+						read_value(value, stream);
+						values.push_back(std::move(value));
+					}
+				}
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_reader<std::array<T, C>> {
+			static void read(std::array<T, C>& values, scts::in_stream& stream) {
+				if constexpr (Encoding::template copies_as_bytes<T>) Encoding::read_values(values.data(), C, stream);
+				else read_values(values.begin(), values.end(), stream);
+			}
+		};
+
+		template <typename V>
+		struct builtin_type_reader<std::map<std::string, V>> {
+			static void read(std::map<std::string, V>& values, scts::in_stream& stream) {
+				const auto length = read_length(stream);
+				values.clear();
+				for (std::uint64_t i = 0; i < length; ++i) {
+					std::string key;
+					V value{};
+					read_value(key, stream);
+					read_value(value, stream);
+					values.insert(std::make_pair(std::move(key), std::move(value)));
+				}
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_reader<std::optional<T>> {
+			static void read(std::optional<T>& value, scts::in_stream& stream) {
+				if (!read_bool(stream)) {
+					value = std::nullopt;
+				}
+				else {
+					value = T{};
+					read_value(value.value(), stream);
+				}
+			}
+		};
+
+		// Standard library smart pointers.
+		template <typename T>
+		struct builtin_type_reader<std::unique_ptr<T>> {
+			static void read(std::unique_ptr<T>& value, scts::in_stream& stream) {
+				if (!read_bool(stream)) {
+					value = nullptr;
+				}
+				else {
+					value = std::make_unique<T>();
+					read_value(*value.get(), stream);
+				}
+			}
+		};
+	};
+
+	using binary_reader = basic_binary_reader<fixed_width_encoding>;
+}
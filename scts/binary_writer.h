@@ -1,18 +1,56 @@
 #pragma once
 
+#include <bitset>
+#include <vector>
+#include <cstdint>
 #include <type_traits>
 
+#include "delta.h"
 #include "stream.h"
 #include "builtin_types.h"
 #include "value_as_binary.h"
+#include "binary_encoding.h"
 
 namespace scts {
-	struct binary_writer {
+	// Writes values in the order of their members. Numbers, enums and the length prefixes of strings and containers are
+	// stored as the Encoding decides, and pointers, optionals and smart pointers are prefixed with a byte telling whether
+	// a value follows. Contiguous containers of values the Encoding stores as bytes are copied as a whole.
+	// In the columnar layout, vectors of registered types are written one member at a time.
+	template <typename Encoding, binary_layout Layout = binary_layout::rows>
+	struct basic_binary_writer {
 		static constexpr bool requires_names = false;
+		static constexpr bool copies_bulk_objects = Encoding::copies_bulk_objects;
 
 		template <typename T>
 		static scts::out_stream& write_member(const T& member, scts::out_stream& stream, bool) {
-			return binary_writer::write_value(member, stream);
+			return write_value(member, stream);
+		}
+
+		template <typename O>
+		static void write_object_bytes(const O& object, scts::out_stream& stream) {
+			write_bulk(std::addressof(object), 1, stream);
+		}
+
+		// The format does not use separators.
+		static void write_inherited_object_separator(scts::out_stream&) { }
+
+		// Writes a bitmap of the members of current that differ from previous, followed by those members.
+		// Changed objects are written as deltas themselves, as are vectors and arrays of objects that kept their length.
+		template <typename O>
+		static void write_delta(const O& previous, const O& current, scts::out_stream& stream) {
+			using descriptor = std::decay_t<decltype(scts::register_type<O>::descriptor)>;
+			std::bitset<descriptor::member_count> changed;
+			std::size_t index = 0;
+			descriptor::for_each_member([&](auto member) {
+				using member_type = decltype(member);
+				changed[index++] = !values_equal(member_type::get(previous), member_type::get(current));
+			});
+			write_bitmap(changed, changed.size(), stream);
+			index = 0;
+			descriptor::for_each_member([&](auto member) {
+				using member_type = decltype(member);
+				if (changed[index++]) write_value_delta(member_type::get(previous), member_type::get(current), stream);
+			});
 		}
 	private:
 		template <typename T>
@@ -22,33 +60,181 @@ namespace scts {
 
 		template <typename T>
 		static typename std::enable_if<!is_builtin_type<T>::value, scts::out_stream&>::type write_value(const T& value, scts::out_stream& stream) {
-			binary_writer writer;
+			basic_binary_writer writer;
 			return scts::register_type<T>::descriptor.save(writer, value, stream);
 		}
 
+		template <typename T>
+		static void write_value_delta(const T& previous, const T& current, scts::out_stream& stream) {
+			if constexpr (is_registered_type_v<T>) {
+				write_delta(previous, current, stream);
+			}
+			else if constexpr (is_object_sequence_v<T> && object_sequence<T>::fixed_size) {
+				write_elements_delta(std::begin(previous), std::begin(current), std::size(current), stream);
+			}
+			else if constexpr (is_object_sequence_v<T>) {
+				const bool same_length = previous.size() == current.size();
+				write_exists(same_length, stream);
+				if (same_length) write_elements_delta(previous.begin(), current.begin(), current.size(), stream);
+				else write_value(current, stream);
+			}
+			else {
+				write_value(current, stream);
+			}
+		}
+
+		// Writes a bitmap of the changed elements, followed by their deltas.
+		template <typename Iterator>
+		static void write_elements_delta(Iterator previous, Iterator current, std::size_t count, scts::out_stream& stream) {
+			std::vector<bool> changed(count);
+			for (std::size_t i = 0; i < count; ++i) changed[i] = !values_equal(previous[i], current[i]);
+			write_bitmap(changed, count, stream);
+			for (std::size_t i = 0; i < count; ++i) {
+				if (changed[i]) write_delta(previous[i], current[i], stream);
+			}
+		}
+
+		static void write_length(std::size_t length, scts::out_stream& stream) {
+			Encoding::write_length(length, stream);
+		}
+
+		static void write_exists(bool exists, scts::out_stream& stream) {
+			scts::value_as_binary(exists).write(stream);
+		}
+
+		template <typename Iterator>
+		static scts::out_stream& write_values(Iterator begin, Iterator end, scts::out_stream& stream) {
+			for (auto current = begin; current != end; ++current) {
+				write_value(*current, stream);
+			}
+			return stream;
+		}
+
+		// Writes the first member of every object, then the second member of every object, and so on.
+		// Members that the Encoding stores as bytes are gathered into a column and copied as a whole.
+		template <typename T>
+		static void write_columns(const std::vector<T>& values, scts::out_stream& stream) {
+			std::decay_t<decltype(scts::register_type<T>::descriptor)>::for_each_member([&](auto member) {
+				using member_type = decltype(member);
+				using value_type = typename member_type::value_type;
+				if constexpr (Encoding::template copies_as_bytes<value_type> && !std::is_array_v<value_type>) {
+					std::vector<value_type> column;
+					column.reserve(values.size());
+					for (const auto& value : values) column.push_back(member_type::get(value));
+					Encoding::write_values(column.data(), column.size(), stream);
+				}
+				else {
+					for (const auto& value : values) write_value(member_type::get(value), stream);
+				}
+			});
+		}
+
+		// Strings and arithmetic types.
 		template <typename T, typename = void>
 		struct builtin_type_writer {
 			static scts::out_stream& write(const T& value, scts::out_stream& stream) {
-				scts::value_as_binary(value).write(stream);
+				if constexpr (std::is_same_v<T, std::string>) {
+					write_length(value.length(), stream);
+					stream.append(value.data(), value.length());
+				}
+				else if constexpr (std::is_same_v<T, bool>) {
+					scts::value_as_binary(value).write(stream);
+				}
+				else {
+					Encoding::write(value, stream);
+				}
 				return stream;
 			}
 		};
 
-		template <>
-		struct builtin_type_writer<std::string> {
-			static scts::out_stream& write(const std::string& value, scts::out_stream& stream) {
-				scts::value_as_binary(value.length()).write(stream);
-				stream << value;
+		// Enums.
+		template <typename Enum>
+		struct builtin_type_writer<Enum, std::enable_if_t<std::is_enum_v<Enum>>> {
+			static scts::out_stream& write(const Enum& value, scts::out_stream& stream) {
+				Encoding::write(value, stream);
+				return stream;
 			}
 		};
 
+		// C-style pointers and arrays.
 		template <typename T>
 		struct builtin_type_writer<T*> {
 			static scts::out_stream& write(const T* value, scts::out_stream& stream) {
 				const bool exists = value != nullptr;
-				stream << exists;
+				write_exists(exists, stream);
 				if (exists) write_value(*value, stream);
+				return stream;
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_writer<T[C]> {
+			static scts::out_stream& write(const T(&values)[C], scts::out_stream& stream) {
+				if constexpr (Encoding::template copies_as_bytes<T>) {
+					Encoding::write_values(values, C, stream);
+					return stream;
+				}
+				else return write_values(std::begin(values), std::end(values), stream);
+			}
+		};
+
+		// Standard library containers and classes.
+		template <typename T>
+		struct builtin_type_writer<std::vector<T>> {
+			static scts::out_stream& write(const std::vector<T>& values, scts::out_stream& stream) {
+				write_length(values.size(), stream);
+				if constexpr (Layout == binary_layout::columns && is_registered_type_v<T>) {
+					write_columns(values, stream);
+					return stream;
+				}
+				else if constexpr (Encoding::template copies_as_bytes<T>) {
+					Encoding::write_values(values.data(), values.size(), stream);
+					return stream;
+				}
+				else return write_values(values.begin(), values.end(), stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_writer<std::array<T, C>> {
+			static scts::out_stream& write(const std::array<T, C>& values, scts::out_stream& stream) {
+				if constexpr (Encoding::template copies_as_bytes<T>) {
+					Encoding::write_values(values.data(), C, stream);
+					return stream;
+				}
+				else return write_values(values.begin(), values.end(), stream);
+			}
+		};
+
+		template <typename V>
+		struct builtin_type_writer<std::map<std::string, V>> {
+			static scts::out_stream& write(const std::map<std::string, V>& values, scts::out_stream& stream) {
+				write_length(values.size(), stream);
+				for (const auto& [key, value] : values) {
+					write_value(key, stream);
+					write_value(value, stream);
+				}
+				return stream;
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_writer<std::optional<T>> {
+			static scts::out_stream& write(const std::optional<T>& value, scts::out_stream& stream) {
+				write_exists(value.has_value(), stream);
+				if (value.has_value()) write_value(value.value(), stream);
+				return stream;
+			}
+		};
+
+		// Standard library smart pointers.
+		template <typename T>
+		struct builtin_type_writer<std::unique_ptr<T>> {
+			static scts::out_stream& write(const std::unique_ptr<T>& value, scts::out_stream& stream) {
+				return builtin_type_writer<T*>::write(value.get(), stream);
 			}
 		};
 	};
-}
\ No newline at end of file
+
+	using binary_writer = basic_binary_writer<fixed_width_encoding>;
+}
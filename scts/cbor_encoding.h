@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+
+#include "stream.h"
+#include "value_as_binary.h"
+#include "binary_encoding.h"
+
+namespace scts {
+	struct invalid_cbor : std::exception {
+		invalid_cbor(std::size_t position) : m_String("Invalid CBOR at position " + std::to_string(position)) { }
+		const char* what() const noexcept override { return m_String.c_str(); }
+	private:
+		const std::string m_String;
+	};
+
+	// The major types and simple values of CBOR (RFC 8949). Every data item starts with a head holding the major type
+	// in its top three bits and either a small argument or the size of the big endian argument that follows.
+	struct cbor_type {
+		static constexpr std::uint8_t unsigned_integer = 0;
+		static constexpr std::uint8_t negative_integer = 1;
+		static constexpr std::uint8_t byte_string = 2;
+		static constexpr std::uint8_t text_string = 3;
+		static constexpr std::uint8_t array = 4;
+		static constexpr std::uint8_t map = 5;
+		static constexpr std::uint8_t tag = 6;
+		static constexpr std::uint8_t simple = 7;
+
+		// Additional information: arguments below 24 are stored in the head itself.
+		static constexpr std::uint8_t one_byte = 24;
+		static constexpr std::uint8_t two_bytes = 25;
+		static constexpr std::uint8_t four_bytes = 26;
+		static constexpr std::uint8_t eight_bytes = 27;
+		static constexpr std::uint8_t indefinite = 31;
+
+		static constexpr std::uint8_t false_value = 0xf4;
+		static constexpr std::uint8_t true_value = 0xf5;
+		static constexpr std::uint8_t null = 0xf6;
+		static constexpr std::uint8_t break_code = 0xff;
+
+		// Vectors and arrays of these types are written as typed arrays (RFC 8746): a tag naming the element type and
+		// byte order, followed by a byte string holding the values as they are in memory.
+		template <typename T>
+		static constexpr bool has_typed_array = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+			&& (std::is_integral_v<T> ? sizeof(T) <= 8 : sizeof(T) == 4 || sizeof(T) == 8);
+
+		// The tag is 0b010fsell: f for floating point, s for signed, e for little endian and ll for the size.
+		// Single byte values have no byte order, and the tags with e set are reserved for other uses.
+		template <typename T>
+		static constexpr std::uint8_t typed_array_tag(bool little_endian) {
+			static_assert(has_typed_array<T>);
+			if constexpr (std::is_floating_point_v<T>) {
+				return static_cast<std::uint8_t>(0x50 | (little_endian ? 0x04 : 0) | (sizeof(T) == 4 ? 1 : 2));
+			}
+			else {
+				const std::uint8_t size = sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 1 : sizeof(T) == 4 ? 2 : 3;
+				return static_cast<std::uint8_t>(0x40 | (std::is_signed_v<T> ? 0x08 : 0) | (little_endian && sizeof(T) > 1 ? 0x04 : 0) | size);
+			}
+		}
+
+		template <typename T>
+		static void write_big_endian(T value, scts::out_stream& stream) {
+			scts::value_as_binary(to_big_endian(value)).write(stream);
+		}
+
+		template <typename T>
+		static T read_big_endian(scts::in_stream& stream) {
+			return to_big_endian(scts::value_as_binary<T>(stream).value());
+		}
+
+		// Writes a head with the shortest encoding of its argument.
+		static void write_head(std::uint8_t major, std::uint64_t argument, scts::out_stream& stream) {
+			const auto type = static_cast<std::uint8_t>(major << 5);
+			if (argument < one_byte) {
+				stream.push_back(static_cast<char>(type | argument));
+			}
+			else if (argument <= 0xff) {
+				stream.push_back(static_cast<char>(type | one_byte));
+				write_big_endian(static_cast<std::uint8_t>(argument), stream);
+			}
+			else if (argument <= 0xffff) {
+				stream.push_back(static_cast<char>(type | two_bytes));
+				write_big_endian(static_cast<std::uint16_t>(argument), stream);
+			}
+			else if (argument <= 0xffffffff) {
+				stream.push_back(static_cast<char>(type | four_bytes));
+				write_big_endian(static_cast<std::uint32_t>(argument), stream);
+			}
+			else {
+				stream.push_back(static_cast<char>(type | eight_bytes));
+				write_big_endian(argument, stream);
+			}
+		}
+	};
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "cbor_writer.h"
+#include "cbor_reader.h"
+
+namespace scts {
+	struct cbor_formatter : cbor_writer, cbor_reader {
+		static constexpr bool requires_names = true;
+	};
+}
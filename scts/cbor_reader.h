@@ -0,0 +1,331 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+
+#include "stream.h"
+#include "helpers.h"
+#include "builtin_types.h"
+#include "reader_helpers.h"
+#include "cbor_encoding.h"
+
+namespace scts {
+	// Reads CBOR. Besides what cbor_writer produces, it reads indefinite length maps and arrays, half precision floats,
+	// plain arrays of numbers and typed arrays in either byte order, so that input from other encoders is read as well.
+	struct cbor_reader {
+		static constexpr bool requires_names = true;
+		static constexpr bool dispatches_by_name = true;
+
+		static void prepare_read(scts::in_stream&) { }
+
+		// Maps of indefinite length end at a break instead of after a count.
+		template <typename Callback>
+		static void read_object(scts::in_stream& stream, Callback&& read_named_member) {
+			const auto map = read_head(stream, cbor_type::map);
+			for (std::uint64_t i = 0; map.indefinite ? !read_break(stream) : i < map.argument; ++i) {
+				const auto name = read_text(stream);
+				if (!read_named_member(name)) skip_value(stream);
+			}
+		}
+
+		template <typename T>
+		static void read_member(T& member, scts::in_stream& stream) {
+			read_value(member, stream);
+		}
+	private:
+		template <typename T>
+		static typename std::enable_if<is_builtin_type<T>::value, void>::type read_value(T& value, scts::in_stream& stream) {
+			builtin_type_reader<T>::read(value, stream);
+		}
+
+		template <typename T>
+		static typename std::enable_if<!is_builtin_type<T>::value, void>::type read_value(T& value, scts::in_stream& stream) {
+			cbor_reader reader;
+			scts::register_type<T>::descriptor.load(reader, value, stream);
+		}
+
+		struct head {
+			std::uint8_t major;
+			std::uint8_t additional;
+			std::uint64_t argument;
+			bool indefinite;
+			std::size_t position;
+		};
+
+		static head read_head(scts::in_stream& stream) {
+			const auto position = stream.position();
+			const auto initial = static_cast<std::uint8_t>(stream.get());
+			head result{ static_cast<std::uint8_t>(initial >> 5), static_cast<std::uint8_t>(initial & 0x1f), 0, false, position };
+			switch (result.additional) {
+			case cbor_type::one_byte: result.argument = cbor_type::read_big_endian<std::uint8_t>(stream); break;
+			case cbor_type::two_bytes: result.argument = cbor_type::read_big_endian<std::uint16_t>(stream); break;
+			case cbor_type::four_bytes: result.argument = cbor_type::read_big_endian<std::uint32_t>(stream); break;
+			case cbor_type::eight_bytes: result.argument = cbor_type::read_big_endian<std::uint64_t>(stream); break;
+			case cbor_type::indefinite:
+				// Only strings, arrays and maps have indefinite lengths, a lone break code is handled by read_break.
+				if (result.major < cbor_type::byte_string || result.major > cbor_type::map) throw invalid_cbor(position);
+				result.indefinite = true;
+				break;
+			default:
+				if (result.additional > cbor_type::eight_bytes) throw invalid_cbor(position);
+				result.argument = result.additional;
+			}
+			return result;
+		}
+
+		static head read_head(scts::in_stream& stream, std::uint8_t major) {
+			const auto result = read_head(stream);
+			if (result.major != major) throw invalid_cbor(result.position);
+			return result;
+		}
+
+		// Consumes a break code if there is one, which ends the items of an indefinite length map or array.
+		static bool read_break(scts::in_stream& stream) {
+			if (static_cast<std::uint8_t>(stream.peek()) != cbor_type::break_code) return false;
+			stream.advance(1);
+			return true;
+		}
+
+		// Consumes a null if there is one.
+		static bool read_null(scts::in_stream& stream) {
+			if (static_cast<std::uint8_t>(stream.peek()) != cbor_type::null) return false;
+			stream.advance(1);
+			return true;
+		}
+
+		static std::string_view read_definite(scts::in_stream& stream, std::uint8_t major) {
+			const auto string = read_head(stream, major);
+			if (string.indefinite || string.argument > stream.remaining()) throw invalid_cbor(string.position);
+			return stream.read(static_cast<std::size_t>(string.argument));
+		}
+
+		static std::string_view read_text(scts::in_stream& stream) {
+			return read_definite(stream, cbor_type::text_string);
+		}
+
+		template <typename T>
+		static T read_number(scts::in_stream& stream) {
+			const auto number = read_head(stream);
+			if constexpr (std::is_same_v<T, bool>) {
+				if (number.major == cbor_type::simple && number.additional == (cbor_type::true_value & 0x1f)) return true;
+				if (number.major == cbor_type::simple && number.additional == (cbor_type::false_value & 0x1f)) return false;
+				throw invalid_cbor(number.position);
+			}
+			else {
+				if (number.major == cbor_type::unsigned_integer) return reader_helpers::to_integer<T, invalid_cbor>(number.argument, number.position);
+				if (number.major == cbor_type::negative_integer) {
+					if constexpr (std::is_floating_point_v<T>) {
+						return static_cast<T>(-1.0L - static_cast<long double>(number.argument));
+					}
+					else {
+						if (number.argument > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) throw invalid_cbor(number.position);
+						return reader_helpers::to_integer<T, invalid_cbor>(-1 - static_cast<std::int64_t>(number.argument), number.position);
+					}
+				}
+				if constexpr (std::is_floating_point_v<T>) {
+					if (number.major == cbor_type::simple) {
+						switch (number.additional) {
+						case cbor_type::two_bytes: return static_cast<T>(half_to_double(static_cast<std::uint16_t>(number.argument)));
+						case cbor_type::four_bytes: return static_cast<T>(bits_to<float>(static_cast<std::uint32_t>(number.argument)));
+						case cbor_type::eight_bytes: return static_cast<T>(bits_to<double>(number.argument));
+						}
+					}
+				}
+				throw invalid_cbor(number.position);
+			}
+		}
+
+		template <typename F, typename U>
+		static F bits_to(U bits) {
+			static_assert(sizeof(F) == sizeof(U));
+			F value;
+			std::memcpy(&value, &bits, sizeof(F));
+			return value;
+		}
+
+		// Half precision floats as decoded in appendix D of RFC 8949.
+		static double half_to_double(std::uint16_t half) {
+			const int exponent = (half >> 10) & 0x1f;
+			const int mantissa = half & 0x3ff;
+			double value;
+			if (exponent == 0) value = std::ldexp(mantissa, -24);
+			else if (exponent != 31) value = std::ldexp(mantissa + 1024, exponent - 25);
+			else value = mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+			return half & 0x8000 ? -value : value;
+		}
+
+		static void skip_items(const head& items, std::uint64_t per_item, scts::in_stream& stream) {
+			if (items.indefinite) {
+				while (!read_break(stream)) skip_value(stream);
+			}
+			else {
+				for (std::uint64_t i = 0; i < items.argument * per_item; ++i) skip_value(stream);
+			}
+		}
+
+		static void skip_value(scts::in_stream& stream) {
+			const auto value = read_head(stream);
+			switch (value.major) {
+			case cbor_type::byte_string:
+			case cbor_type::text_string:
+				// Indefinite length strings are a sequence of definite length chunks.
+				if (value.indefinite) skip_items(value, 1, stream);
+				else if (value.argument > stream.remaining()) throw invalid_cbor(value.position);
+				else stream.advance(static_cast<std::size_t>(value.argument));
+				break;
+			case cbor_type::array: skip_items(value, 1, stream); break;
+			case cbor_type::map: skip_items(value, 2, stream); break;
+			case cbor_type::tag: skip_value(stream); break;
+			default: break;
+			}
+		}
+
+		template <typename T>
+		struct builtin_list_reader {
+			// Reads into values, which the function resizes to the count it is given.
+			template <typename Values, typename Resize>
+			static void read(Values& values, Resize&& resize, scts::in_stream& stream) {
+				if constexpr (cbor_type::has_typed_array<T>) {
+					const auto type = static_cast<std::uint8_t>(stream.peek()) >> 5;
+					if (type == cbor_type::tag || (sizeof(T) == 1 && type == cbor_type::byte_string)) return read_typed_array(values, resize, stream);
+				}
+
+				const auto array = read_head(stream, cbor_type::array);
+				if (array.indefinite) {
+					std::vector<T> items;
+					while (!read_break(stream)) read_value(items.emplace_back(), stream);
+					resize(items.size());
+					std::move(items.begin(), items.end(), std::begin(values));
+				}
+				else {
+					if (array.argument > stream.remaining()) throw invalid_cbor(array.position);
+					resize(static_cast<std::size_t>(array.argument));
+					for (auto& value : values) read_value(value, stream);
+				}
+			}
+
+			// Typed arrays in the other byte order are swapped after copying. Byte strings are read as typed arrays of bytes.
+			template <typename Values, typename Resize>
+			static void read_typed_array(Values& values, Resize&& resize, scts::in_stream& stream) {
+				bool swap = false;
+				if (static_cast<std::uint8_t>(stream.peek()) >> 5 == cbor_type::tag) {
+					const auto tag = read_head(stream);
+					swap = tag.argument != cbor_type::typed_array_tag<T>(host_is_little_endian);
+					if (swap && tag.argument != cbor_type::typed_array_tag<T>(!host_is_little_endian)) throw invalid_cbor(tag.position);
+				}
+				const auto position = stream.position();
+				const auto bytes = read_definite(stream, cbor_type::byte_string);
+				if (bytes.size() % sizeof(T) != 0) throw invalid_cbor(position);
+				const auto count = bytes.size() / sizeof(T);
+				resize(count);
+				if (count == 0) return;
+				const auto first = &*std::begin(values);
+				std::memcpy(first, bytes.data(), bytes.size());
+				if constexpr (sizeof(T) > 1) {
+					if (swap) byte_swap_values<sizeof(T)>(reinterpret_cast<char*>(first), count);
+				}
+			}
+		};
+
+		// Strings and arithmetic types.
+		template <typename T, typename = void>
+		struct builtin_type_reader {
+			static void read(T& value, scts::in_stream& stream) {
+				if constexpr (std::is_same_v<T, std::string>) value = std::string(read_text(stream));
+				else value = read_number<T>(stream);
+			}
+		};
+
+		// Enums.
+		template <typename Enum>
+		struct builtin_type_reader<Enum, std::enable_if_t<std::is_enum_v<Enum>>> {
+			static void read(Enum& value, scts::in_stream& stream) {
+				value = static_cast<Enum>(read_number<std::underlying_type_t<Enum>>(stream));
+			}
+		};
+
+		// C-style pointers and arrays.
+		template <typename T>
+		struct builtin_type_reader<T*> {
+			static void read(T*& value, scts::in_stream& stream) {
+				if (read_null(stream)) {
+					value = nullptr;
+				}
+				else {
+					read_value(scts::allocate_pointee(value), stream);
+				}
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_reader<T[C]> {
+			static void read(T(&values)[C], scts::in_stream& stream) {
+				reader_helpers::read_fixed_list<builtin_list_reader<T>, invalid_cbor, C>(values, stream);
+			}
+		};
+
+		// Standard library containers and classes.
+		template <typename T>
+		struct builtin_type_reader<std::vector<T>> {
+			static void read(std::vector<T>& values, scts::in_stream& stream) {
+				reader_helpers::read_vector<builtin_list_reader<T>>(values, stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_reader<std::array<T, C>> {
+			static void read(std::array<T, C>& values, scts::in_stream& stream) {
+				reader_helpers::read_fixed_list<builtin_list_reader<T>, invalid_cbor, C>(values.data(), stream);
+			}
+		};
+
+		template <typename V>
+		struct builtin_type_reader<std::map<std::string, V>> {
+			static void read(std::map<std::string, V>& values, scts::in_stream& stream) {
+				const auto map = read_head(stream, cbor_type::map);
+				values.clear();
+				for (std::uint64_t i = 0; map.indefinite ? !read_break(stream) : i < map.argument; ++i) {
+					std::string key(read_text(stream));
+					V value{};
+					read_value(value, stream);
+					values.insert(std::make_pair(std::move(key), std::move(value)));
+				}
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_reader<std::optional<T>> {
+			static void read(std::optional<T>& value, scts::in_stream& stream) {
+				if (read_null(stream)) {
+					value = std::nullopt;
+				}
+				else {
+					value = T{};
+					read_value(value.value(), stream);
+				}
+			}
+		};
+
+		// Standard library smart pointers.
+		template <typename T>
+		struct builtin_type_reader<std::unique_ptr<T>> {
+			static void read(std::unique_ptr<T>& value, scts::in_stream& stream) {
+				if (read_null(stream)) {
+					value = nullptr;
+				}
+				else {
+					value = std::make_unique<T>();
+					read_value(*value.get(), stream);
+				}
+			}
+		};
+	};
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "stream.h"
+#include "builtin_types.h"
+#include "cbor_encoding.h"
+
+namespace scts {
+	// Writes registered types as CBOR maps keyed by the names of their descriptors. All lengths are definite and taken
+	// from the sizes of the containers. Vectors and arrays of numbers are written as typed arrays in host byte order,
+	// so that they are copied with a single memcpy in both directions.
+	struct cbor_writer {
+		static constexpr bool requires_names = true;
+
+		// The root map always takes the four byte length argument, so that post_write can patch the count in place.
+		void prepare_write(scts::out_stream& stream) {
+			m_root = stream.size();
+			m_root_members = 0;
+			m_depth = 0;
+			stream.push_back(static_cast<char>(cbor_type::map << 5 | cbor_type::four_bytes));
+			cbor_type::write_big_endian(std::uint32_t(0), stream);
+		}
+
+		void post_write(scts::out_stream& stream) {
+			const auto count = to_big_endian(m_root_members);
+			std::memcpy(stream.data() + m_root + 1, &count, sizeof(count));
+		}
+
+		template <typename T>
+		scts::out_stream& write_member(const T& value, scts::out_stream& stream, const std::string_view& name, bool) {
+			static_assert(scts::is_serializable_v<T>);
+
+			if (m_depth == 0) m_root_members++;
+			write_text(name, stream);
+			write_value(value, stream);
+			return stream;
+		}
+
+		static void write_inherited_object_separator(scts::out_stream&) { }
+	private:
+		template <typename T>
+		typename std::enable_if<is_builtin_type<T>::value, void>::type write_value(const T& value, scts::out_stream& stream) {
+			builtin_type_writer<T>::write(*this, value, stream);
+		}
+
+		template <typename T>
+		typename std::enable_if<!is_builtin_type<T>::value, void>::type write_value(const T& value, scts::out_stream& stream) {
+			const auto& descriptor = scts::register_type<T>::descriptor;
+			cbor_type::write_head(cbor_type::map, std::decay_t<decltype(descriptor)>::member_count, stream);
+			m_depth++;
+			descriptor.save(*this, value, stream);
+			m_depth--;
+		}
+
+		static void write_text(std::string_view value, scts::out_stream& stream) {
+			cbor_type::write_head(cbor_type::text_string, value.size(), stream);
+			stream.append(value);
+		}
+
+		template <typename T>
+		static void write_number(T value, scts::out_stream& stream) {
+			if constexpr (std::is_same_v<T, bool>) {
+				stream.push_back(static_cast<char>(value ? cbor_type::true_value : cbor_type::false_value));
+			}
+			else if constexpr (std::is_same_v<T, float>) {
+				stream.push_back(static_cast<char>(cbor_type::simple << 5 | cbor_type::four_bytes));
+				cbor_type::write_big_endian(value, stream);
+			}
+			else if constexpr (std::is_floating_point_v<T>) {
+				stream.push_back(static_cast<char>(cbor_type::simple << 5 | cbor_type::eight_bytes));
+				cbor_type::write_big_endian(static_cast<double>(value), stream);
+			}
+			else if constexpr (std::is_signed_v<T>) {
+				// Negative integers store -1 - value, which is the complement of its two's complement representation.
+				const auto wide = static_cast<std::int64_t>(value);
+				if (wide < 0) cbor_type::write_head(cbor_type::negative_integer, ~static_cast<std::uint64_t>(wide), stream);
+				else cbor_type::write_head(cbor_type::unsigned_integer, static_cast<std::uint64_t>(wide), stream);
+			}
+			else {
+				cbor_type::write_head(cbor_type::unsigned_integer, static_cast<std::uint64_t>(value), stream);
+			}
+		}
+
+		template <typename T>
+		struct builtin_list_writer {
+			template <typename Iterator>
+			static void write(cbor_writer& writer, Iterator begin, std::size_t size, scts::out_stream& stream) {
+				if constexpr (cbor_type::has_typed_array<T>) {
+					cbor_type::write_head(cbor_type::tag, cbor_type::typed_array_tag<T>(host_is_little_endian), stream);
+					cbor_type::write_head(cbor_type::byte_string, size * sizeof(T), stream);
+					write_bulk(size == 0 ? nullptr : &*begin, size, stream);
+				}
+				else {
+					cbor_type::write_head(cbor_type::array, size, stream);
+					for (std::size_t i = 0; i < size; ++i, ++begin) writer.write_value(*begin, stream);
+				}
+			}
+		};
+
+		// Strings and arithmetic types.
+		template <typename T, typename = void>
+		struct builtin_type_writer {
+			static void write(cbor_writer&, const T& value, scts::out_stream& stream) {
+				if constexpr (std::is_same_v<T, std::string>) write_text(value, stream);
+				else write_number(value, stream);
+			}
+		};
+
+		// Enums.
+		template <typename Enum>
+		struct builtin_type_writer<Enum, std::enable_if_t<std::is_enum_v<Enum>>> {
+			static void write(cbor_writer&, const Enum& value, scts::out_stream& stream) {
+				write_number(static_cast<std::underlying_type_t<Enum>>(value), stream);
+			}
+		};
+
+		// C-style pointers and arrays.
+		template <typename T>
+		struct builtin_type_writer<T*> {
+			static void write(cbor_writer& writer, const T* value, scts::out_stream& stream) {
+				if (value == nullptr) stream.push_back(static_cast<char>(cbor_type::null));
+				else writer.write_value(*value, stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_writer<T[C]> {
+			static void write(cbor_writer& writer, const T(&values)[C], scts::out_stream& stream) {
+				builtin_list_writer<T>::write(writer, std::begin(values), C, stream);
+			}
+		};
+
+		// Standard library containers and classes.
+		template <typename T>
+		struct builtin_type_writer<std::vector<T>> {
+			static void write(cbor_writer& writer, const std::vector<T>& values, scts::out_stream& stream) {
+				builtin_list_writer<T>::write(writer, values.begin(), values.size(), stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_writer<std::array<T, C>> {
+			static void write(cbor_writer& writer, const std::array<T, C>& values, scts::out_stream& stream) {
+				builtin_list_writer<T>::write(writer, values.begin(), C, stream);
+			}
+		};
+
+		template <typename V>
+		struct builtin_type_writer<std::map<std::string, V>> {
+			static void write(cbor_writer& writer, const std::map<std::string, V>& values, scts::out_stream& stream) {
+				cbor_type::write_head(cbor_type::map, values.size(), stream);
+				for (const auto& [key, value] : values) {
+					write_text(key, stream);
+					writer.write_value(value, stream);
+				}
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_writer<std::optional<T>> {
+			static void write(cbor_writer& writer, const std::optional<T>& value, scts::out_stream& stream) {
+				if (value.has_value()) writer.write_value(value.value(), stream);
+				else stream.push_back(static_cast<char>(cbor_type::null));
+			}
+		};
+
+		// Standard library smart pointers.
+		template <typename T>
+		struct builtin_type_writer<std::unique_ptr<T>> {
+			static void write(cbor_writer& writer, const std::unique_ptr<T>& value, scts::out_stream& stream) {
+				builtin_type_writer<T*>::write(writer, value.get(), stream);
+			}
+		};
+
+		std::size_t m_root = 0;
+		std::uint32_t m_root_members = 0;
+		std::size_t m_depth = 0;
+	};
+}
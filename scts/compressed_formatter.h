@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+#include "stream.h"
+#include "lz_codec.h"
+#include "value_as_binary.h"
+#include "binary_encoding.h"
+
+namespace scts {
+	// Compresses the output of Formatter with lz_codec, and decompresses the input before Formatter reads it.
+	// The output is split into blocks that are compressed one at a time in place, over the bytes already compressed,
+	// so only a single block is ever held next to it. Blocks that do not get smaller are stored as they are.
+	// The compressed frame, with all numbers as 32-bit little endian values:
+	// - the block size
+	// - for each block its stored size, with the highest bit set if it is stored as it is, followed by the block
+	// - a stored size of zero ending the frame
+	// Pass it to serialize and deserialize like any other formatter, e.g. compressed<json_formatter>.
+	template <typename Formatter>
+	struct compressed : Formatter {
+		static constexpr std::size_t default_block_size = std::size_t(1) << 16;
+		static constexpr std::size_t max_block_size = std::size_t(1) << 24;
+
+		compressed(Formatter formatter = Formatter(), std::size_t block_size = default_block_size)
+			: Formatter(std::move(formatter)), m_block_size(std::clamp<std::size_t>(block_size, 1, max_block_size)) { }
+
+		void prepare_write(scts::out_stream& stream) {
+			m_start = stream.size();
+			Formatter::prepare_write(stream);
+		}
+
+		void post_write(scts::out_stream& stream) {
+			Formatter::post_write(stream);
+			compress(stream);
+		}
+
+		// The decompressed data is held by the formatter, so it needs to outlive the reading, as deserialize ensures.
+		void prepare_read(scts::in_stream& stream) {
+			decompress(stream);
+			stream = scts::in_stream(m_decompressed.view());
+			Formatter::prepare_read(stream);
+		}
+	private:
+		static constexpr std::uint32_t stored_flag = std::uint32_t(1) << 31;
+
+		static void write_u32(char* at, std::uint32_t value) noexcept {
+			value = to_little_endian(value);
+			std::memcpy(at, &value, sizeof(value));
+		}
+
+		static std::uint32_t read_u32(scts::in_stream& stream) {
+			return to_little_endian(scts::value_as_binary<std::uint32_t>(stream).value());
+		}
+
+		void compress(scts::out_stream& stream) {
+			const auto size = stream.size() - m_start;
+			const auto blocks = (size + m_block_size - 1) / m_block_size;
+			// Every block grows by at most its header, so moving the output back by all headers once
+			// keeps the compressed blocks from ever overtaking the bytes that are still to be compressed.
+			const auto overhead = sizeof(std::uint32_t) * (blocks + 2);
+			stream.prepare(overhead);
+			stream.commit(overhead);
+			const auto data = stream.data() + m_start;
+			std::memmove(data + overhead, data, size);
+
+			std::vector<std::uint32_t> table(lz_codec::hash_table_size);
+			std::vector<char> block(std::min(m_block_size, size));
+			write_u32(data, static_cast<std::uint32_t>(m_block_size));
+			auto written = sizeof(std::uint32_t);
+			for (std::size_t read = 0; read < size; read += m_block_size) {
+				const auto input = data + overhead + read;
+				const auto length = std::min(m_block_size, size - read);
+				const auto compressed_size = lz_codec::compress(input, length, block.data(), length - 1, table.data());
+				if (compressed_size == 0) {
+					write_u32(data + written, static_cast<std::uint32_t>(length) | stored_flag);
+					std::memmove(data + written + sizeof(std::uint32_t), input, length);
+					written += sizeof(std::uint32_t) + length;
+				}
+				else {
+					write_u32(data + written, static_cast<std::uint32_t>(compressed_size));
+					std::memcpy(data + written + sizeof(std::uint32_t), block.data(), compressed_size);
+					written += sizeof(std::uint32_t) + compressed_size;
+				}
+			}
+			write_u32(data + written, 0);
+			stream.truncate(m_start + written + sizeof(std::uint32_t));
+		}
+
+		void decompress(scts::in_stream& stream) {
+			const auto block_size = read_u32(stream);
+			if (block_size == 0 || block_size > max_block_size) throw invalid_compressed_data(stream.position() - sizeof(std::uint32_t));
+			m_decompressed.clear();
+			for (auto header = read_u32(stream); header != 0; header = read_u32(stream)) {
+				const auto stored_size = header & ~stored_flag;
+				if (stored_size > block_size) throw invalid_compressed_data(stream.position() - sizeof(std::uint32_t));
+				const auto block = stream.read(stored_size);
+				if ((header & stored_flag) != 0) {
+					m_decompressed.append(block);
+				}
+				else {
+					const auto out = m_decompressed.prepare(block_size);
+					try {
+						m_decompressed.commit(lz_codec::decompress(block, out, block_size));
+					}
+					catch (const invalid_compressed_data&) {
+						throw invalid_compressed_data(stream.position() - stored_size);
+					}
+				}
+			}
+		}
+
+		std::size_t m_block_size;
+		std::size_t m_start = 0;
+		scts::out_stream m_decompressed;
+	};
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SCTS_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Allows using intrinsics of an instruction set in a function, without requiring it for the whole translation unit.
+// MSVC always allows this, GCC and Clang need the function to be marked.
+#if defined(__GNUC__) || defined(__clang__)
+#define SCTS_TARGET(instruction_set) __attribute__((target(instruction_set)))
+#else
+#define SCTS_TARGET(instruction_set)
+#endif
+
+namespace scts {
+	// The optional instruction sets scts has kernels for, detected once at runtime.
+	struct cpu_features {
+		bool sse2 = false;
+		bool sse42 = false;
+		bool avx2 = false;
+
+		static const cpu_features& get() {
+			static const cpu_features features = detect();
+			return features;
+		}
+	private:
+		static cpu_features detect() {
+			cpu_features features;
+#if defined(SCTS_X86) && defined(_MSC_VER)
+			int registers[4] = {};
+			__cpuid(registers, 0);
+			const auto highest_leaf = registers[0];
+
+			__cpuid(registers, 1);
+			features.sse2 = (registers[3] & (1 << 26)) != 0;
+			features.sse42 = (registers[2] & (1 << 20)) != 0;
+			const auto os_saves_avx = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+
+			if (highest_leaf >= 7) {
+				__cpuidex(registers, 7, 0);
+				features.avx2 = os_saves_avx && (registers[1] & (1 << 5)) != 0;
+			}
+#elif defined(SCTS_X86)
+			__builtin_cpu_init();
+			features.sse2 = __builtin_cpu_supports("sse2");
+			features.sse42 = __builtin_cpu_supports("sse4.2");
+			features.avx2 = __builtin_cpu_supports("avx2");
+#endif
+			return features;
+		}
+	};
+
+	inline std::uint32_t count_trailing_zeros(std::uint64_t value) noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return index;
+#elif defined(_MSC_VER)
+		unsigned long index;
+		if (_BitScanForward(&index, static_cast<unsigned long>(value))) return index;
+		_BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+		return index + 32;
+#else
+		return static_cast<std::uint32_t>(__builtin_ctzll(value));
+#endif
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "cpu_features.h"
+#include "binary_encoding.h"
+
+namespace scts {
+	namespace crc32c_detail {
+		inline constexpr std::uint32_t polynomial = 0x82f63b78;
+
+		struct lookup_tables {
+			std::uint32_t values[8][256];
+		};
+
+		// values[0] is the usual table for one byte, values[n] advances the result of values[n - 1] by another zero byte.
+		constexpr lookup_tables make_tables() noexcept {
+			lookup_tables tables{};
+			for (std::uint32_t i = 0; i < 256; ++i) {
+				auto crc = i;
+				for (int bit = 0; bit < 8; ++bit) crc = (crc & 1) != 0 ? (crc >> 1) ^ polynomial : crc >> 1;
+				tables.values[0][i] = crc;
+			}
+			for (std::size_t table = 1; table < 8; ++table) {
+				for (std::size_t i = 0; i < 256; ++i) {
+					const auto previous = tables.values[table - 1][i];
+					tables.values[table][i] = (previous >> 8) ^ tables.values[0][previous & 0xff];
+				}
+			}
+			return tables;
+		}
+
+		inline constexpr lookup_tables tables = make_tables();
+	}
+
+	// CRC-32C (Castagnoli), the checksum that SSE4.2 has instructions for.
+	// The software fallback looks up eight bytes at a time in tables generated at compile time.
+	struct crc32c {
+		// Continues crc, which starts out as 0, over size more bytes. Splitting the data in any way gives the same result.
+		static std::uint32_t update(std::uint32_t crc, const char* data, std::size_t size) noexcept {
+#if defined(SCTS_X86)
+			if (cpu_features::get().sse42) return ~update_sse42(~crc, data, size);
+#endif
+			return ~update_slicing_by_8(~crc, data, size);
+		}
+
+		static std::uint32_t compute(std::string_view data) noexcept {
+			return update(0, data.data(), data.size());
+		}
+
+		// The same as update, but never uses SSE4.2.
+		static std::uint32_t update_software(std::uint32_t crc, const char* data, std::size_t size) noexcept {
+			return ~update_slicing_by_8(~crc, data, size);
+		}
+	private:
+		static std::uint32_t load32(const char* bytes) noexcept {
+			std::uint32_t value;
+			std::memcpy(&value, bytes, sizeof(value));
+			return to_little_endian(value);
+		}
+
+		static std::uint32_t update_slicing_by_8(std::uint32_t crc, const char* data, std::size_t size) noexcept {
+			const auto& t = crc32c_detail::tables.values;
+			for (; size >= 8; size -= 8, data += 8) {
+				const auto low = load32(data) ^ crc;
+				const auto high = load32(data + 4);
+				crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^
+					t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+			}
+			for (; size > 0; --size, ++data) {
+				crc = t[0][(crc ^ static_cast<std::uint8_t>(*data)) & 0xff] ^ (crc >> 8);
+			}
+			return crc;
+		}
+
+#if defined(SCTS_X86)
+		SCTS_TARGET("sse4.2")
+		static std::uint32_t update_sse42(std::uint32_t crc, const char* data, std::size_t size) noexcept {
+#if defined(_M_X64) || defined(__x86_64__)
+			std::uint64_t wide = crc;
+			for (; size >= 8; size -= 8, data += 8) {
+				std::uint64_t value;
+				std::memcpy(&value, data, sizeof(value));
+				wide = _mm_crc32_u64(wide, value);
+			}
+			crc = static_cast<std::uint32_t>(wide);
+#endif
+			for (; size >= 4; size -= 4, data += 4) {
+				std::uint32_t value;
+				std::memcpy(&value, data, sizeof(value));
+				crc = _mm_crc32_u32(crc, value);
+			}
+			for (; size > 0; --size, ++data) {
+				crc = _mm_crc32_u8(crc, static_cast<std::uint8_t>(*data));
+			}
+			return crc;
+		}
+#endif
+	};
+}
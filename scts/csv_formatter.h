@@ -0,0 +1,242 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <optional>
+#include <exception>
+#include <string_view>
+#include <type_traits>
+
+#include "stream.h"
+#include "lexical_cast.h"
+#include "builtin_types.h"
+
+namespace scts {
+	struct invalid_csv : std::exception {
+		invalid_csv(std::size_t position) : m_String("Invalid CSV at position " + std::to_string(position)) { }
+		const char* what() const noexcept override { return m_String.c_str(); }
+	private:
+		const std::string m_String;
+	};
+
+	// Writes and reads flat objects as a single row of delimiter separated fields, in the order of their descriptor.
+	// Fields holding the delimiter, quotes or line breaks are quoted as in RFC 4180, with quotes doubled.
+	// Members need to be strings, numbers, enums or optionals of those. An empty optional is an empty field,
+	// while an empty string inside an optional is written as "" to tell them apart.
+	// csv_writer and csv_reader in csv_stream.h add the header line and stream many rows.
+	struct csv_formatter {
+		static constexpr bool requires_names = false;
+
+		static constexpr char comma = ',';
+		static constexpr char tab = '\t';
+
+		explicit csv_formatter(char delimiter = comma) noexcept : m_delimiter(delimiter) { }
+
+		template <typename T>
+		static constexpr bool is_field_v = std::is_same_v<T, std::string> || std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+		char delimiter() const noexcept { return m_delimiter; }
+
+		// Reading:
+		void prepare_read(scts::in_stream&) noexcept {
+			m_first_field = true;
+		}
+
+		template <typename T>
+		void read_member(T& value, scts::in_stream& stream) {
+			if (!m_first_field) {
+				if (stream.empty() || stream.peek() != m_delimiter) throw invalid_csv(stream.position());
+				stream.advance(1);
+			}
+			m_first_field = false;
+			bool quoted = false;
+			const auto field = read_field(stream, quoted);
+			if constexpr (is_optional<T>::value) {
+				static_assert(is_field_v<typename T::value_type>, "csv fields need to be strings, numbers, enums or optionals of those");
+				if (field.empty() && !quoted) value = std::nullopt;
+				else value = parse<typename T::value_type>(field, stream);
+			}
+			else {
+				static_assert(is_field_v<T>, "csv fields need to be strings, numbers, enums or optionals of those");
+				value = parse<T>(field, stream);
+			}
+		}
+
+		// Skips a field of a column no member reads.
+		void skip_member(scts::in_stream& stream) {
+			if (!m_first_field) {
+				if (stream.empty() || stream.peek() != m_delimiter) throw invalid_csv(stream.position());
+				stream.advance(1);
+			}
+			m_first_field = false;
+			bool quoted = false;
+			read_field(stream, quoted);
+		}
+
+		// Consumes the line break at the end of a row, either \n or \r\n. The last row does not need one.
+		static void read_line_end(scts::in_stream& stream) {
+			if (stream.empty()) return;
+			if (stream.peek() == '\r') stream.advance(1);
+			if (stream.get() != '\n') throw invalid_csv(stream.position() - 1);
+		}
+
+		// Reads the fields of a whole line, such as the header.
+		std::vector<std::string> read_line(scts::in_stream& stream) {
+			std::vector<std::string> fields;
+			bool quoted = false;
+			fields.emplace_back(read_field(stream, quoted));
+			while (!stream.empty() && stream.peek() == m_delimiter) {
+				stream.advance(1);
+				fields.emplace_back(read_field(stream, quoted));
+			}
+			read_line_end(stream);
+			return fields;
+		}
+
+		// Writing:
+		void prepare_write(scts::out_stream&) noexcept {
+			m_first_field = true;
+		}
+
+		static void post_write(scts::out_stream& stream) {
+			stream.push_back('\n');
+		}
+
+		template <typename T>
+		scts::out_stream& write_member(const T& value, scts::out_stream& stream, bool) {
+			if (!m_first_field) stream.push_back(m_delimiter);
+			m_first_field = false;
+			if constexpr (is_optional<T>::value) {
+				static_assert(is_field_v<typename T::value_type>, "csv fields need to be strings, numbers, enums or optionals of those");
+				if (!value.has_value()) return stream;
+				if constexpr (std::is_same_v<typename T::value_type, std::string>) {
+					if (value->empty()) return stream << "\"\"";
+				}
+				write_value(*value, stream);
+			}
+			else {
+				static_assert(is_field_v<T>, "csv fields need to be strings, numbers, enums or optionals of those");
+				write_value(value, stream);
+			}
+			return stream;
+		}
+
+		// Parents are just more columns of the same row.
+		static void write_inherited_object_separator(scts::out_stream&) { }
+
+		// Writes text as a single field, quoted if it needs to be.
+		void write_text(std::string_view text, scts::out_stream& stream) const {
+			const char special[] = { m_delimiter, '"', '\n', '\r' };
+			if (text.find_first_of(std::string_view(special, sizeof(special))) == std::string_view::npos) {
+				stream << text;
+				return;
+			}
+			stream.push_back('"');
+			for (std::size_t quote; (quote = text.find('"')) != std::string_view::npos; text.remove_prefix(quote + 1)) {
+				stream << text.substr(0, quote + 1);
+				stream.push_back('"');
+			}
+			stream << text;
+			stream.push_back('"');
+		}
+
+		void write_delimiter(scts::out_stream& stream) const {
+			stream.push_back(m_delimiter);
+		}
+	private:
+		template <typename T>
+		struct is_optional : std::false_type { };
+		template <typename T>
+		struct is_optional<std::optional<T>> : std::true_type { };
+
+		template <typename T>
+		void write_value(const T& value, scts::out_stream& stream) const {
+			if constexpr (std::is_same_v<T, std::string>) {
+				write_text(value, stream);
+			}
+			else if constexpr (std::is_same_v<T, char>) {
+				write_text(std::string_view(&value, 1), stream);
+			}
+			else if constexpr (std::is_same_v<T, bool>) {
+				stream << (value ? "true" : "false");
+			}
+			else if constexpr (std::is_enum_v<T>) {
+				write_value(static_cast<std::underlying_type_t<T>>(value), stream);
+			}
+			else if constexpr (std::is_same_v<T, std::int8_t> || std::is_same_v<T, std::uint8_t>) {
+				stream << static_cast<int>(value);
+			}
+			else {
+				stream << value;
+			}
+		}
+
+		template <typename T>
+		static T parse(std::string_view field, const scts::in_stream& stream) {
+			if constexpr (std::is_same_v<T, std::string>) {
+				return std::string(field);
+			}
+			else if constexpr (std::is_same_v<T, bool>) {
+				if (field == "true" || field == "1") return true;
+				if (field == "false" || field == "0") return false;
+				throw invalid_csv(stream.position());
+			}
+			else if constexpr (std::is_same_v<T, char>) {
+				if (field.size() != 1) throw invalid_csv(stream.position());
+				return field.front();
+			}
+			else if constexpr (std::is_enum_v<T>) {
+				return static_cast<T>(parse_number<std::underlying_type_t<T>>(field));
+			}
+			else {
+				return parse_number<T>(field);
+			}
+		}
+
+		// Reads a field up to the next delimiter or line break, without consuming those. Quoted fields without doubled
+		// quotes and unquoted fields are views of the input, only quoted fields with doubled quotes are copied.
+		std::string_view read_field(scts::in_stream& stream, bool& quoted) {
+			const auto rest = stream.rest();
+			quoted = !rest.empty() && rest.front() == '"';
+			if (!quoted) {
+				const char ends[] = { m_delimiter, '\n', '\r' };
+				const auto size = std::min(rest.find_first_of(std::string_view(ends, sizeof(ends))), rest.size());
+				stream.advance(size);
+				return rest.substr(0, size);
+			}
+
+			const auto start = stream.position();
+			std::string_view field;
+			bool copied = false;
+			for (std::size_t begin = 1;;) {
+				const auto quote = rest.find('"', begin);
+				if (quote == std::string_view::npos) throw invalid_csv(start);
+				if (quote + 1 < rest.size() && rest[quote + 1] == '"') {
+					// A doubled quote, which stands for a single one.
+					if (!copied) m_unescaped.clear();
+					copied = true;
+					m_unescaped.append(rest.data() + begin, quote + 1 - begin);
+					begin = quote + 2;
+					continue;
+				}
+				if (copied) {
+					m_unescaped.append(rest.data() + begin, quote - begin);
+					field = m_unescaped;
+				}
+				else {
+					field = rest.substr(1, quote - 1);
+				}
+				stream.advance(quote + 1);
+				break;
+			}
+			if (!stream.empty() && stream.peek() != m_delimiter && stream.peek() != '\n' && stream.peek() != '\r') throw invalid_csv(stream.position());
+			return field;
+		}
+
+		char m_delimiter;
+		bool m_first_field = true;
+		std::string m_unescaped;
+	};
+}
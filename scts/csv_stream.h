@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <string_view>
+
+#include "stream.h"
+#include "csv_formatter.h"
+#include "register_type.h"
+#include "descriptor_io.h"
+
+namespace scts {
+	// Writes registered flat objects as rows of a CSV (or TSV) file, after a header line of the member names that is written
+	// on construction, so that a file without rows still has it. Members of parents come first, as the descriptor orders them.
+	// The descriptor needs to have names.
+	// Rows are formatted straight into the sink, so memory use doesn't grow with the amount of rows: either an out_stream
+	// of the caller, or a buffer written to a file descriptor whenever it holds flush_size bytes.
+	template <typename O>
+	struct csv_writer {
+		static_assert(scts::is_registered_type_v<O>, "cannot write an object type that is not registerd");
+
+		static constexpr std::size_t flush_size = std::size_t(64) << 10;
+
+		explicit csv_writer(scts::out_stream& stream, csv_formatter formatter = csv_formatter())
+			: m_stream(stream), m_formatter(std::move(formatter)) {
+			write_header();
+		}
+
+		// The descriptor is not closed, but the rows still buffered are written to it on destruction.
+		explicit csv_writer(int descriptor, csv_formatter formatter = csv_formatter())
+			: m_stream(m_buffer), m_formatter(std::move(formatter)), m_descriptor(descriptor) {
+			write_header();
+		}
+
+		csv_writer(const csv_writer&) = delete;
+		csv_writer& operator=(const csv_writer&) = delete;
+
+		~csv_writer() {
+			try {
+				flush();
+			}
+			catch (...) {
+				// Destructors can't report errors, call flush() first to see them.
+			}
+		}
+
+		void write(const O& object) {
+			m_formatter.prepare_write(m_stream);
+			scts::register_type<O>::descriptor.save(m_formatter, object, m_stream);
+			m_formatter.post_write(m_stream);
+			if (m_descriptor >= 0 && m_buffer.size() >= flush_size) flush();
+		}
+
+		// Writes the buffered rows to the file descriptor. Does nothing when writing to an out_stream.
+		void flush() {
+			if (m_descriptor < 0 || m_buffer.size() == 0) return;
+			descriptor_io::write_all(m_descriptor, m_buffer.data(), m_buffer.size());
+			m_buffer.clear();
+		}
+	private:
+		void write_header() {
+			bool first = true;
+			scts::register_type<O>::descriptor.for_each_named_member([&](auto, std::string_view name) {
+				if (!first) m_formatter.write_delimiter(m_stream);
+				first = false;
+				m_formatter.write_text(name, m_stream);
+			});
+			m_stream.push_back('\n');
+		}
+
+		scts::out_stream m_buffer;
+		scts::out_stream& m_stream;
+		csv_formatter m_formatter;
+		int m_descriptor = -1;
+	};
+
+	// Reads the rows of a CSV (or TSV) file with a header line into registered flat objects, one at a time.
+	// The columns are matched to members by the names in the header once, when the reader is constructed, so the
+	// columns can be in any order. Columns without a member are skipped, and members without a column are left untouched.
+	// The input is only viewed, never copied.
+	template <typename O>
+	struct csv_reader {
+		static_assert(scts::is_registered_type_v<O>, "cannot read an object type that is not registerd");
+
+		explicit csv_reader(scts::in_stream stream, csv_formatter formatter = csv_formatter())
+			: m_stream(stream), m_formatter(std::move(formatter)) {
+			if (m_stream.empty()) return;
+			const auto header = m_formatter.read_line(m_stream);
+			m_columns.resize(header.size(), nullptr);
+			scts::register_type<O>::descriptor.for_each_named_member([&](auto member, std::string_view name) {
+				using member_type = decltype(member);
+				for (std::size_t i = 0; i < header.size(); ++i) {
+					if (header[i] != name) continue;
+					m_columns[i] = [](csv_formatter& reader, O& object, scts::in_stream& row) {
+						reader.read_member(member_type::get(object), row);
+					};
+					break;
+				}
+			});
+		}
+
+		// Reads the next row into object. Returns false if there are no rows left.
+		bool read(O& object) {
+			if (m_stream.empty()) return false;
+			m_formatter.prepare_read(m_stream);
+			for (const auto column : m_columns) {
+				if (column != nullptr) column(m_formatter, object, m_stream);
+				else m_formatter.skip_member(m_stream);
+			}
+			csv_formatter::read_line_end(m_stream);
+			return true;
+		}
+	private:
+		using column_reader = void (*)(csv_formatter&, O&, scts::in_stream&);
+
+		scts::in_stream m_stream;
+		csv_formatter m_formatter;
+		std::vector<column_reader> m_columns;
+	};
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+#include "stream.h"
+#include "builtin_types.h"
+#include "register_type.h"
+
+namespace scts {
+	// Compares two values member by member, so that registered types do not need an equality operator of their own.
+	// Used to find out which members a delta needs to carry.
+	template <typename T, typename = void>
+	struct value_equality;
+
+	template <typename T>
+	bool values_equal(const T& first, const T& second) {
+		return value_equality<T>::equal(first, second);
+	}
+
+	// Strings, arithmetic types and enums.
+	template <typename T, typename>
+	struct value_equality {
+		static bool equal(const T& first, const T& second) { return first == second; }
+	};
+
+	// Registered types.
+	template <typename O>
+	struct value_equality<O, std::enable_if_t<is_registered_type_v<O>>> {
+		static bool equal(const O& first, const O& second) {
+			bool equal = true;
+			std::decay_t<decltype(scts::register_type<O>::descriptor)>::for_each_member([&](auto member) {
+				using member_type = decltype(member);
+				equal = equal && values_equal(member_type::get(first), member_type::get(second));
+			});
+			return equal;
+		}
+	};
+
+	template <typename Iterator>
+	bool ranges_equal(Iterator first, Iterator last, Iterator second) {
+		for (; first != last; ++first, ++second) {
+			if (!values_equal(*first, *second)) return false;
+		}
+		return true;
+	}
+
+	// C-style pointers and arrays.
+	template <typename T>
+	struct value_equality<T*> {
+		static bool equal(const T* first, const T* second) {
+			if (first == nullptr || second == nullptr) return first == second;
+			return values_equal(*first, *second);
+		}
+	};
+	template <typename T, std::size_t C>
+	struct value_equality<T[C]> {
+		static bool equal(const T(&first)[C], const T(&second)[C]) { return ranges_equal(std::begin(first), std::end(first), std::begin(second)); }
+	};
+
+	// Standard library containers and classes.
+	template <typename T>
+	struct value_equality<std::vector<T>> {
+		static bool equal(const std::vector<T>& first, const std::vector<T>& second) {
+			return first.size() == second.size() && ranges_equal(first.begin(), first.end(), second.begin());
+		}
+	};
+	template <typename T, std::size_t C>
+	struct value_equality<std::array<T, C>> {
+		static bool equal(const std::array<T, C>& first, const std::array<T, C>& second) { return ranges_equal(first.begin(), first.end(), second.begin()); }
+	};
+	template <typename V>
+	struct value_equality<std::map<std::string, V>> {
+		static bool equal(const std::map<std::string, V>& first, const std::map<std::string, V>& second) {
+			if (first.size() != second.size()) return false;
+			for (auto current = first.begin(), other = second.begin(); current != first.end(); ++current, ++other) {
+				if (current->first != other->first || !values_equal(current->second, other->second)) return false;
+			}
+			return true;
+		}
+	};
+	template <typename T>
+	struct value_equality<std::optional<T>> {
+		static bool equal(const std::optional<T>& first, const std::optional<T>& second) {
+			if (!first.has_value() || !second.has_value()) return first.has_value() == second.has_value();
+			return values_equal(first.value(), second.value());
+		}
+	};
+
+	// Standard library smart pointers.
+	template <typename T>
+	struct value_equality<std::unique_ptr<T>> {
+		static bool equal(const std::unique_ptr<T>& first, const std::unique_ptr<T>& second) { return values_equal(first.get(), second.get()); }
+	};
+
+	// Sequences of registered types, which deltas can describe element by element.
+	template <typename T>
+	struct object_sequence : std::false_type {
+		static constexpr bool fixed_size = false;
+	};
+	template <typename T>
+	struct object_sequence<std::vector<T>> : std::bool_constant<is_registered_type_v<T>> {
+		static constexpr bool fixed_size = false;
+	};
+	template <typename T, std::size_t C>
+	struct object_sequence<std::array<T, C>> : std::bool_constant<is_registered_type_v<T>> {
+		static constexpr bool fixed_size = true;
+	};
+	template <typename T, std::size_t C>
+	struct object_sequence<T[C]> : std::bool_constant<is_registered_type_v<T>> {
+		static constexpr bool fixed_size = true;
+	};
+
+	template <typename T>
+	inline constexpr bool is_object_sequence_v = object_sequence<T>::value;
+
+	// Bitmaps of changed members or elements, one bit each starting from the lowest bit of the first byte.
+	template <typename Bits>
+	void write_bitmap(const Bits& bits, std::size_t count, scts::out_stream& stream) {
+		const auto size = (count + 7) / 8;
+		const auto bytes = stream.prepare(size);
+		std::memset(bytes, 0, size);
+		for (std::size_t i = 0; i < count; ++i) {
+			if (bits[i]) bytes[i / 8] = static_cast<char>(bytes[i / 8] | (1 << (i % 8)));
+		}
+		stream.commit(size);
+	}
+
+	template <typename Bits>
+	void read_bitmap(Bits& bits, std::size_t count, scts::in_stream& stream) {
+		const auto bytes = stream.read((count + 7) / 8);
+		for (std::size_t i = 0; i < count; ++i) {
+			bits[i] = ((static_cast<unsigned char>(bytes[i / 8]) >> (i % 8)) & 1) != 0;
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cerrno>
+#include <limits>
+#include <cstddef>
+#include <algorithm>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace scts {
+	// Unbuffered reading and writing of file descriptors, such as pipes and sockets.
+	namespace descriptor_io {
+		// Reads at most count bytes, returning 0 at the end of the input.
+		inline std::size_t read_some(int descriptor, char* bytes, std::size_t count) {
+			for (;;) {
+#if defined(_WIN32)
+				const auto result = ::_read(descriptor, bytes, static_cast<unsigned int>(std::min<std::size_t>(count, std::numeric_limits<int>::max())));
+#else
+				const auto result = ::read(descriptor, bytes, count);
+#endif
+				if (result >= 0) return static_cast<std::size_t>(result);
+				if (errno != EINTR) throw std::system_error(errno, std::generic_category(), "Reading from a file descriptor failed");
+			}
+		}
+
+		// Writes all count bytes, however many writes that takes.
+		inline void write_all(int descriptor, const char* bytes, std::size_t count) {
+			while (count > 0) {
+#if defined(_WIN32)
+				const auto result = ::_write(descriptor, bytes, static_cast<unsigned int>(std::min<std::size_t>(count, std::numeric_limits<int>::max())));
+#else
+				const auto result = ::write(descriptor, bytes, count);
+#endif
+				if (result < 0) {
+					if (errno == EINTR) continue;
+					throw std::system_error(errno, std::generic_category(), "Writing to a file descriptor failed");
+				}
+				bytes += result;
+				count -= static_cast<std::size_t>(result);
+			}
+		}
+	}
+}
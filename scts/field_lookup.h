@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+namespace scts {
+	namespace field_lookup_detail {
+		struct entry {
+			std::uint32_t field_number;
+			std::uint16_t index;
+		};
+
+		template <std::size_t N>
+		constexpr std::uint32_t max_field_number(const std::array<std::uint32_t, N>& field_numbers) noexcept {
+			std::uint32_t max = 0;
+			for (const auto field_number : field_numbers) max = field_number > max ? field_number : max;
+			return max;
+		}
+
+		template <std::size_t N>
+		constexpr bool all_unique(const std::array<std::uint32_t, N>& field_numbers) noexcept {
+			for (std::size_t i = 0; i < N; ++i) {
+				if (field_numbers[i] == 0) return false;
+				for (std::size_t j = 0; j < i; ++j) {
+					if (field_numbers[i] == field_numbers[j]) return false;
+				}
+			}
+			return true;
+		}
+
+		// Copies the field numbers of from into to, starting at index at. Returns the index after the last one copied.
+		template <std::size_t N, std::size_t M>
+		constexpr std::size_t append(std::array<std::uint32_t, N>& to, std::size_t at, const std::array<std::uint32_t, M>& from) noexcept {
+			for (std::size_t i = 0; i < M; ++i) to[at + i] = from[i];
+			return at + M;
+		}
+
+		// Indices are stored offset by one, so that zero marks a field number without a member.
+		template <std::size_t Size, std::size_t N>
+		constexpr std::array<std::uint16_t, Size> direct_table(const std::array<std::uint32_t, N>& field_numbers) noexcept {
+			std::array<std::uint16_t, Size> table{};
+			for (std::size_t i = 0; i < N; ++i) {
+				if (field_numbers[i] < Size) table[field_numbers[i]] = static_cast<std::uint16_t>(i + 1);
+			}
+			return table;
+		}
+
+		template <std::size_t N>
+		constexpr std::array<entry, N> sorted_table(const std::array<std::uint32_t, N>& field_numbers) noexcept {
+			std::array<entry, N> table{};
+			for (std::size_t i = 0; i < N; ++i) {
+				auto position = i;
+				while (position > 0 && table[position - 1].field_number > field_numbers[i]) {
+					table[position] = table[position - 1];
+					position--;
+				}
+				table[position] = entry{ field_numbers[i], static_cast<std::uint16_t>(i) };
+			}
+			return table;
+		}
+	}
+
+	// A table from field numbers to member indices, built at compile time from the field numbers of a members<> list.
+	// Field numbers are usually small and close together, so they index a direct table. Sparse field numbers,
+	// which would make that table too large, are found by a binary search over the sorted field numbers instead.
+	template <std::uint32_t... FieldNumbers>
+	struct field_lookup {
+		static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+		// Returns the index of the member with the given field number, or npos if there is no such member.
+		static constexpr std::size_t find(std::uint32_t field_number) noexcept {
+			if constexpr (is_direct) {
+				if (field_number > max_field_number) return npos;
+				const std::size_t index = direct_table[field_number];
+				return index == 0 ? npos : index - 1;
+			}
+			else {
+				std::size_t first = 0, last = count;
+				while (first < last) {
+					const auto middle = first + (last - first) / 2;
+					if (sorted_table[middle].field_number < field_number) first = middle + 1;
+					else last = middle;
+				}
+				if (first == count || sorted_table[first].field_number != field_number) return npos;
+				return sorted_table[first].index;
+			}
+		}
+	private:
+		static constexpr std::size_t count = sizeof...(FieldNumbers);
+		static constexpr std::array<std::uint32_t, count> field_numbers{ FieldNumbers... };
+
+		static_assert(field_lookup_detail::all_unique(field_numbers), "every member needs a unique field number");
+		static_assert(count < std::numeric_limits<std::uint16_t>::max(), "too many members for a field_lookup");
+
+		static constexpr std::uint32_t max_field_number = field_lookup_detail::max_field_number(field_numbers);
+		static constexpr bool is_direct = max_field_number <= 4 * count + 16;
+
+		static constexpr auto direct_table = field_lookup_detail::direct_table<is_direct ? max_field_number + 1 : 1>(field_numbers);
+		static constexpr auto sorted_table = field_lookup_detail::sorted_table(field_numbers);
+	};
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <optional>
+#include <exception>
+#include <type_traits>
+
+#include "name_lookup.h"
+#include "builtin_types.h"
+#include "register_type.h"
+
+namespace scts {
+	struct schema_mismatch : std::exception {
+		const char* what() const noexcept override { return "The data was serialized with a different object descriptor"; }
+	};
+
+	// Mixes value into seed, so that both the values and their order affect the result.
+	constexpr std::uint64_t combine_fingerprint(std::uint64_t seed, std::uint64_t value) noexcept {
+		auto hash = seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	// A compile time fingerprint of the shape of a type. Registered types use the fingerprint of their descriptor,
+	// which covers the types and names of their members and their parents. Types that are stored the same way,
+	// such as C arrays and std::arrays, have the same fingerprint.
+	template <typename T, typename = void>
+	struct type_fingerprint;
+
+	template <typename T>
+	inline constexpr std::uint64_t type_fingerprint_v = type_fingerprint<T>::value;
+
+	// Basic data types.
+	template <>
+	struct type_fingerprint<std::string> {
+		static constexpr std::uint64_t value = hash_name("string");
+	};
+	template <typename T>
+	struct type_fingerprint<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+		static constexpr std::uint64_t value = combine_fingerprint(
+			hash_name(std::is_same_v<T, bool> ? "bool" : std::is_floating_point_v<T> ? "float" : std::is_signed_v<T> ? "signed" : "unsigned"),
+			sizeof(T));
+	};
+
+	// Enums.
+	template <typename E>
+	struct type_fingerprint<E, std::enable_if_t<std::is_enum_v<E>>> {
+		static constexpr std::uint64_t value = combine_fingerprint(hash_name("enum"), type_fingerprint_v<std::underlying_type_t<E>>);
+	};
+
+	// Registered types.
+	template <typename O>
+	struct type_fingerprint<O, std::enable_if_t<is_registered_type_v<O>>> {
+		static constexpr std::uint64_t value = register_type<O>::descriptor.fingerprint();
+	};
+
+	// C-style pointers and arrays.
+	// Registered types behind pointers only count as objects, so that types may point to themselves.
+	template <typename T>
+	constexpr std::uint64_t pointee_fingerprint() noexcept {
+		if constexpr (is_registered_type_v<T>) return hash_name("object");
+		else return type_fingerprint_v<T>;
+	}
+
+	template <typename T>
+	struct type_fingerprint<T*> {
+		static constexpr std::uint64_t value = combine_fingerprint(hash_name("pointer"), pointee_fingerprint<T>());
+	};
+	template <typename T, std::size_t C>
+	struct type_fingerprint<T[C]> {
+		static constexpr std::uint64_t value = combine_fingerprint(combine_fingerprint(hash_name("array"), type_fingerprint_v<T>), C);
+	};
+
+	// Standard library containers and classes.
+	template <typename T>
+	struct type_fingerprint<std::vector<T>> {
+		static constexpr std::uint64_t value = combine_fingerprint(hash_name("vector"), type_fingerprint_v<T>);
+	};
+	template <typename T, std::size_t C>
+	struct type_fingerprint<std::array<T, C>> : type_fingerprint<T[C]> { };
+	template <typename V>
+	struct type_fingerprint<std::map<std::string, V>> {
+		static constexpr std::uint64_t value = combine_fingerprint(hash_name("map"), type_fingerprint_v<V>);
+	};
+	template <typename T>
+	struct type_fingerprint<std::optional<T>> {
+		static constexpr std::uint64_t value = combine_fingerprint(hash_name("optional"), type_fingerprint_v<T>);
+	};
+
+	// Standard library smart pointers.
+	template <typename T>
+	struct type_fingerprint<std::unique_ptr<T>> : type_fingerprint<T*> { };
+}
@@ -0,0 +1,447 @@
+#pragma once
+
+#include <map>
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "stream.h"
+#include "fingerprint.h"
+#include "helpers.h"
+#include "builtin_types.h"
+#include "register_type.h"
+#include "binary_encoding.h"
+
+namespace scts {
+	struct invalid_flat_layout : std::exception {
+		invalid_flat_layout(std::size_t position) : m_String("Invalid flat layout at position " + std::to_string(position)) { }
+		const char* what() const noexcept override { return m_String.c_str(); }
+	private:
+		const std::string m_String;
+	};
+
+	// The flat layout lets values be read straight out of the buffer, see flat_view.
+	// Every value is found through its position from the start of the payload, and all numbers are little endian:
+	// - the payload starts with the position of the root object and the fingerprint of its descriptor
+	// - numbers and enums are stored as they are, bools as a byte
+	// - strings are a 32-bit length followed by the characters
+	// - objects are a table: the count of members, including those of parents, followed by the position of each member
+	// - vectors and arrays are a count, followed by the numbers themselves, or by the positions of other values
+	// - maps are a count, followed by the positions of each key and value, in key order
+	// - optionals, pointers and smart pointers are the position of the value, or zero if there is none
+	// Values are written before anything that refers to them, so positions always point backwards.
+	struct flat_layout {
+		using position = std::uint32_t;
+
+		static constexpr std::size_t header_size = sizeof(position) + sizeof(std::uint64_t);
+		static constexpr std::size_t max_payload_size = std::numeric_limits<position>::max();
+
+		// Values that are stored in place in vectors and arrays.
+		template <typename T>
+		static constexpr bool is_inline = (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>;
+
+		template <typename U>
+		static U load(std::string_view payload, std::size_t at) {
+			if (at > payload.size() || payload.size() - at < sizeof(U)) throw unexpected_end_of_stream();
+			if constexpr (std::is_same_v<U, bool>) {
+				return payload[at] != 0;
+			}
+			else {
+				U value;
+				std::memcpy(&value, payload.data() + at, sizeof(U));
+				return to_little_endian(value);
+			}
+		}
+
+		// Reads the position stored at the given position. It needs to point backwards, which rules out cycles.
+		static position follow(std::string_view payload, std::size_t at) {
+			const auto target = load<position>(payload, at);
+			if (target >= at) throw invalid_flat_layout(at);
+			return target;
+		}
+
+		// The position the root object table, after checking the header.
+		static position root(std::string_view payload, std::uint64_t fingerprint) {
+			if (load<std::uint64_t>(payload, sizeof(position)) != fingerprint) throw schema_mismatch();
+			const auto table = load<position>(payload, 0);
+			if (table < header_size) throw invalid_flat_layout(0);
+			return table;
+		}
+	};
+
+	// Writes and reads the flat layout. Use flat_view to access the serialized data without deserializing it.
+	// Payloads are limited to 4 GiB.
+	struct flat_formatter {
+		static constexpr bool requires_names = false;
+		static constexpr bool checks_schema = true;
+
+		using position = flat_layout::position;
+
+		// Reading:
+		void prepare_read(scts::in_stream& stream) {
+			m_payload = stream.rest();
+			stream.advance(flat_layout::header_size);
+		}
+
+		void check_fingerprint(std::uint64_t expected, scts::in_stream&) {
+			enter_table(flat_layout::root(m_payload, expected));
+		}
+
+		template <typename T>
+		void read_member(T& member, scts::in_stream& stream) {
+			if (m_next_slot == m_slot_count) throw schema_mismatch();
+			const auto slot = m_table + sizeof(position) * (1 + m_next_slot++);
+			read_value(member, flat_layout::follow(m_payload, slot), stream);
+		}
+
+		// Writing:
+		void prepare_write(scts::out_stream& stream) {
+			m_start = stream.size();
+			m_slots.clear();
+			// The root position is filled in by post_write.
+			little_endian_encoding::write(position(0), stream);
+		}
+
+		static void write_fingerprint(std::uint64_t fingerprint, scts::out_stream& stream) {
+			little_endian_encoding::write(fingerprint, stream);
+		}
+
+		void post_write(scts::out_stream& stream) {
+			const auto root = to_little_endian(write_table(0, stream));
+			std::memcpy(stream.data() + m_start, &root, sizeof(root));
+		}
+
+		template <typename T>
+		scts::out_stream& write_member(const T& member, scts::out_stream& stream, bool) {
+			const auto value = write_value(member, stream);
+			m_slots.push_back(value);
+			return stream;
+		}
+
+		// Parent members go into the same table as the members of the object.
+		static void write_inherited_object_separator(scts::out_stream&) { }
+	private:
+		position current_position(const scts::out_stream& stream) const {
+			const auto size = stream.size() - m_start;
+			if (size > flat_layout::max_payload_size) throw std::length_error("flat layout payloads are limited to 4 GiB");
+			return static_cast<position>(size);
+		}
+
+		// Writes the slots collected since start as a table, and removes them.
+		position write_table(std::size_t start, scts::out_stream& stream) {
+			const auto table = write_positions(m_slots.data() + start, m_slots.size() - start, stream);
+			m_slots.resize(start);
+			return table;
+		}
+
+		position write_positions(const position* positions, std::size_t count, scts::out_stream& stream) {
+			const auto at = current_position(stream);
+			little_endian_encoding::write(static_cast<position>(count), stream);
+			little_endian_encoding::write_values(positions, count, stream);
+			return at;
+		}
+
+		template <typename T>
+		position write_value(const T& value, scts::out_stream& stream) {
+			if constexpr (is_registered_type_v<T>) {
+				const auto start = m_slots.size();
+				scts::register_type<T>::descriptor.save(*this, value, stream);
+				return write_table(start, stream);
+			}
+			else {
+				return builtin_type_writer<T>::write(*this, value, stream);
+			}
+		}
+
+		template <typename T>
+		position write_values(const T* values, std::size_t count, scts::out_stream& stream) {
+			if constexpr (flat_layout::is_inline<T>) {
+				const auto at = current_position(stream);
+				little_endian_encoding::write(static_cast<position>(count), stream);
+				little_endian_encoding::write_values(values, count, stream);
+				return at;
+			}
+			else {
+				const auto start = m_slots.size();
+				for (std::size_t i = 0; i < count; ++i) {
+					const auto value = write_value(values[i], stream);
+					m_slots.push_back(value);
+				}
+				return write_table(start, stream);
+			}
+		}
+
+		template <typename T>
+		position write_optional(const T* value, scts::out_stream& stream) {
+			const position target = value != nullptr ? write_value(*value, stream) : 0;
+			const auto at = current_position(stream);
+			little_endian_encoding::write(target, stream);
+			return at;
+		}
+
+		template <typename T>
+		void read_value(T& value, position at, scts::in_stream& stream) {
+			if constexpr (is_registered_type_v<T>) {
+				const auto table = m_table;
+				const auto slot_count = m_slot_count;
+				const auto next_slot = m_next_slot;
+				enter_table(at);
+				scts::register_type<T>::descriptor.load(*this, value, stream);
+				m_table = table;
+				m_slot_count = slot_count;
+				m_next_slot = next_slot;
+			}
+			else {
+				builtin_type_reader<T>::read(*this, value, at, stream);
+			}
+		}
+
+		void enter_table(position at) {
+			m_table = at;
+			m_slot_count = flat_layout::load<position>(m_payload, at);
+			m_next_slot = 0;
+		}
+
+		// Reads a sequence of count values into values, which has room for exactly that many.
+		template <typename T>
+		void read_values(T* values, std::size_t count, position at, scts::in_stream& stream) {
+			const auto elements = at + sizeof(position);
+			if constexpr (flat_layout::is_inline<T>) {
+				scts::in_stream sequence(m_payload);
+				sequence.seek(elements);
+				little_endian_encoding::read_values(values, count, sequence);
+			}
+			else {
+				for (std::size_t i = 0; i < count; ++i) {
+					read_value(values[i], flat_layout::follow(m_payload, elements + sizeof(position) * i), stream);
+				}
+			}
+		}
+
+		// Checks that a count read from the payload could fit in it, before anything is allocated for it.
+		template <typename T>
+		position read_count(position at) const {
+			const auto count = flat_layout::load<position>(m_payload, at);
+			const auto element_size = flat_layout::is_inline<T> ? sizeof(T) : sizeof(position);
+			if (count > (m_payload.size() - at) / element_size) throw unexpected_end_of_stream();
+			return count;
+		}
+
+		template <typename T>
+		void read_fixed_values(T* values, std::size_t count, position at, scts::in_stream& stream) {
+			if (read_count<T>(at) != count) throw schema_mismatch();
+			read_values(values, count, at, stream);
+		}
+
+		// Strings, bools, numbers and enums.
+		template <typename T, typename = void>
+		struct builtin_type_writer {
+			static position write(flat_formatter& formatter, const T& value, scts::out_stream& stream) {
+				const auto at = formatter.current_position(stream);
+				if constexpr (std::is_same_v<T, std::string>) {
+					little_endian_encoding::write(static_cast<position>(value.size()), stream);
+					stream.append(value.data(), value.size());
+				}
+				else if constexpr (std::is_same_v<T, bool>) {
+					scts::value_as_binary(value).write(stream);
+				}
+				else {
+					little_endian_encoding::write(value, stream);
+				}
+				return at;
+			}
+		};
+
+		template <typename T, typename = void>
+		struct builtin_type_reader {
+			static void read(flat_formatter& formatter, T& value, position at, scts::in_stream&) {
+				if constexpr (std::is_same_v<T, std::string>) {
+					const auto length = flat_layout::load<position>(formatter.m_payload, at);
+					scts::in_stream characters(formatter.m_payload);
+					characters.seek(at + sizeof(position));
+					value = std::string(characters.read(length));
+				}
+				else {
+					value = flat_layout::load<T>(formatter.m_payload, at);
+				}
+			}
+		};
+
+		// C-style pointers and arrays.
+		template <typename T>
+		struct builtin_type_writer<T*> {
+			static position write(flat_formatter& formatter, const T* value, scts::out_stream& stream) {
+				return formatter.write_optional(value, stream);
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_reader<T*> {
+			static void read(flat_formatter& formatter, T*& value, position at, scts::in_stream& stream) {
+				const auto target = flat_layout::load<position>(formatter.m_payload, at);
+				if (target == 0) {
+					value = nullptr;
+				}
+				else {
+					formatter.read_value(scts::allocate_pointee(value), flat_layout::follow(formatter.m_payload, at), stream);
+				}
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_writer<T[C]> {
+			static position write(flat_formatter& formatter, const T(&values)[C], scts::out_stream& stream) {
+				return formatter.write_values(values, C, stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_reader<T[C]> {
+			static void read(flat_formatter& formatter, T(&values)[C], position at, scts::in_stream& stream) {
+				formatter.read_fixed_values(values, C, at, stream);
+			}
+		};
+
+		// Standard library containers and classes.
+		template <typename T>
+		struct builtin_type_writer<std::vector<T>> {
+			static position write(flat_formatter& formatter, const std::vector<T>& values, scts::out_stream& stream) {
+				if constexpr (std::is_same_v<T, bool>) {
+					// Vectors of bools do not store their values contiguously.
+					const std::unique_ptr<bool[]> copy(new bool[values.size()]);
+					std::copy(values.begin(), values.end(), copy.get());
+					return formatter.write_values(copy.get(), values.size(), stream);
+				}
+				else {
+					return formatter.write_values(values.data(), values.size(), stream);
+				}
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_reader<std::vector<T>> {
+			static void read(flat_formatter& formatter, std::vector<T>& values, position at, scts::in_stream& stream) {
+				const auto count = formatter.read_count<T>(at);
+				if constexpr (std::is_same_v<T, bool>) {
+					const std::unique_ptr<bool[]> copy(new bool[count]);
+					formatter.read_values(copy.get(), count, at, stream);
+					values.assign(copy.get(), copy.get() + count);
+				}
+				else {
+					values.clear();
+					values.resize(count);
+					formatter.read_values(values.data(), count, at, stream);
+				}
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_writer<std::array<T, C>> {
+			static position write(flat_formatter& formatter, const std::array<T, C>& values, scts::out_stream& stream) {
+				return formatter.write_values(values.data(), C, stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_reader<std::array<T, C>> {
+			static void read(flat_formatter& formatter, std::array<T, C>& values, position at, scts::in_stream& stream) {
+				formatter.read_fixed_values(values.data(), C, at, stream);
+			}
+		};
+
+		template <typename V>
+		struct builtin_type_writer<std::map<std::string, V>> {
+			static position write(flat_formatter& formatter, const std::map<std::string, V>& values, scts::out_stream& stream) {
+				const auto start = formatter.m_slots.size();
+				for (const auto& [key, value] : values) {
+					const auto key_position = formatter.write_value(key, stream);
+					const auto value_position = formatter.write_value(value, stream);
+					formatter.m_slots.push_back(key_position);
+					formatter.m_slots.push_back(value_position);
+				}
+				const auto at = formatter.current_position(stream);
+				little_endian_encoding::write(static_cast<position>(values.size()), stream);
+				little_endian_encoding::write_values(formatter.m_slots.data() + start, formatter.m_slots.size() - start, stream);
+				formatter.m_slots.resize(start);
+				return at;
+			}
+		};
+
+		template <typename V>
+		struct builtin_type_reader<std::map<std::string, V>> {
+			static void read(flat_formatter& formatter, std::map<std::string, V>& values, position at, scts::in_stream& stream) {
+				const auto count = flat_layout::load<position>(formatter.m_payload, at);
+				values.clear();
+				for (std::size_t i = 0; i < count; ++i) {
+					const auto pair = at + sizeof(position) * (1 + 2 * i);
+					std::string key;
+					V value{};
+					formatter.read_value(key, flat_layout::follow(formatter.m_payload, pair), stream);
+					formatter.read_value(value, flat_layout::follow(formatter.m_payload, pair + sizeof(position)), stream);
+					values.insert(std::make_pair(std::move(key), std::move(value)));
+				}
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_writer<std::optional<T>> {
+			static position write(flat_formatter& formatter, const std::optional<T>& value, scts::out_stream& stream) {
+				return formatter.write_optional(value.has_value() ? std::addressof(value.value()) : nullptr, stream);
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_reader<std::optional<T>> {
+			static void read(flat_formatter& formatter, std::optional<T>& value, position at, scts::in_stream& stream) {
+				if (flat_layout::load<position>(formatter.m_payload, at) == 0) {
+					value = std::nullopt;
+				}
+				else {
+					value = T{};
+					formatter.read_value(value.value(), flat_layout::follow(formatter.m_payload, at), stream);
+				}
+			}
+		};
+
+		// Standard library smart pointers.
+		template <typename T>
+		struct builtin_type_writer<std::unique_ptr<T>> {
+			static position write(flat_formatter& formatter, const std::unique_ptr<T>& value, scts::out_stream& stream) {
+				return formatter.write_optional(value.get(), stream);
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_reader<std::unique_ptr<T>> {
+			static void read(flat_formatter& formatter, std::unique_ptr<T>& value, position at, scts::in_stream& stream) {
+				if (flat_layout::load<position>(formatter.m_payload, at) == 0) {
+					value = nullptr;
+				}
+				else {
+					value = std::make_unique<T>();
+					formatter.read_value(*value, flat_layout::follow(formatter.m_payload, at), stream);
+				}
+			}
+		};
+
+		// Writing state: where the payload starts in the stream, and the positions of the values of the objects,
+		// sequences and maps being written, innermost last.
+		std::size_t m_start = 0;
+		std::vector<position> m_slots;
+
+		// Reading state: the payload and the table of the object being read.
+		std::string_view m_payload;
+		position m_table = 0;
+		position m_slot_count = 0;
+		position m_next_slot = 0;
+	};
+}
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <map>
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+#include "helpers.h"
+#include "flat_formatter.h"
+#include "register_type.h"
+#include "object_descriptor.h"
+
+namespace scts {
+	template <typename T> struct flat_view;
+	template <typename T> struct flat_vector;
+	template <typename V> struct flat_map;
+
+	template <typename T>
+	struct flat_access;
+
+	// The type that viewing a T in the flat layout gives.
+	template <typename T>
+	using flat_value_t = typename flat_access<T>::type;
+
+	namespace flat_detail {
+		inline constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+		template <typename O>
+		using descriptor_type = std::decay_t<decltype(scts::register_type<O>::descriptor)>;
+
+		template <auto A, auto B>
+		constexpr bool same_member() noexcept {
+			if constexpr (std::is_same_v<decltype(A), decltype(B)>) return A == B;
+			else return false;
+		}
+
+		template <typename InheritsFrom>
+		struct parents;
+
+		// The amount of slots in the table of O, which holds the members of its parents first.
+		template <typename O>
+		constexpr std::size_t member_count() noexcept {
+			return descriptor_type<O>::member_count;
+		}
+
+		template <auto Ptr, typename... Members>
+		constexpr std::size_t index_in(scts::members<Members...>) noexcept {
+			std::size_t index = 0;
+			std::size_t found = npos;
+			((found = (found == npos && same_member<Ptr, Members::pointer>()) ? index : found, ++index), ...);
+			return found;
+		}
+
+		// The slot of the member Ptr in the table of O, or npos if neither O nor its parents have it.
+		template <typename O, auto Ptr>
+		constexpr std::size_t slot_of() noexcept {
+			using descriptor = descriptor_type<O>;
+			using inherited = parents<typename descriptor::parents_type>;
+			const auto inherited_slot = inherited::template slot_of<Ptr>();
+			if (inherited_slot != npos) return inherited_slot;
+			const auto own = index_in<Ptr>(typename descriptor::members_type{});
+			return own == npos ? npos : inherited::member_count() + own;
+		}
+
+		template <typename... Parents>
+		struct parents<scts::inherits_from<Parents...>> {
+			static constexpr std::size_t member_count() noexcept {
+				return (flat_detail::member_count<Parents>() + ... + 0);
+			}
+
+			template <auto Ptr>
+			static constexpr std::size_t slot_of() noexcept {
+				[[maybe_unused]] std::size_t offset = 0;
+				std::size_t found = npos;
+				((found = found == npos && flat_detail::slot_of<Parents, Ptr>() != npos ? offset + flat_detail::slot_of<Parents, Ptr>() : found,
+					offset += flat_detail::member_count<Parents>()), ...);
+				return found;
+			}
+		};
+	}
+
+	// Strings, bools, numbers and enums.
+	template <typename T>
+	struct flat_access {
+		using type = std::conditional_t<std::is_same_v<T, std::string>, std::string_view,
+			std::conditional_t<scts::is_registered_type_v<T>, flat_view<T>, T>>;
+
+		static type read(std::string_view payload, flat_layout::position at) {
+			if constexpr (std::is_same_v<T, std::string>) {
+				const auto length = flat_layout::load<flat_layout::position>(payload, at);
+				const auto characters = at + sizeof(flat_layout::position);
+				if (length > payload.size() - characters) throw unexpected_end_of_stream();
+				return payload.substr(characters, length);
+			}
+			else if constexpr (scts::is_registered_type_v<T>) {
+				return flat_view<T>(payload, at);
+			}
+			else {
+				return flat_layout::load<T>(payload, at);
+			}
+		}
+	};
+
+	template <typename T>
+	struct flat_sequence_access {
+		using type = flat_vector<T>;
+		static type read(std::string_view payload, flat_layout::position at) { return type(payload, at); }
+	};
+
+	template <typename T>
+	struct flat_optional_access {
+		using type = std::optional<flat_value_t<T>>;
+
+		static type read(std::string_view payload, flat_layout::position at) {
+			if (flat_layout::load<flat_layout::position>(payload, at) == 0) return std::nullopt;
+			return flat_access<T>::read(payload, flat_layout::follow(payload, at));
+		}
+	};
+
+	// C-style pointers and arrays.
+	template <typename T>
+	struct flat_access<T*> : flat_optional_access<T> { };
+	template <typename T, std::size_t C>
+	struct flat_access<T[C]> : flat_sequence_access<T> { };
+
+	// Standard library containers and classes.
+	template <typename T>
+	struct flat_access<std::vector<T>> : flat_sequence_access<T> { };
+	template <typename T, std::size_t C>
+	struct flat_access<std::array<T, C>> : flat_sequence_access<T> { };
+	template <typename V>
+	struct flat_access<std::map<std::string, V>> {
+		using type = flat_map<V>;
+		static type read(std::string_view payload, flat_layout::position at) { return type(payload, at); }
+	};
+	template <typename T>
+	struct flat_access<std::optional<T>> : flat_optional_access<T> { };
+
+	// Standard library smart pointers.
+	template <typename T>
+	struct flat_access<std::unique_ptr<T>> : flat_optional_access<T> { };
+
+	// A view of an object in a buffer written with flat_formatter. Members are read straight out of the buffer when
+	// they are accessed: numbers by value, strings as string_views, objects as flat_views, vectors and arrays as
+	// flat_vectors, maps as flat_maps, and optionals and pointers as std::optionals of those.
+	// The buffer needs to outlive the view and everything read from it.
+	template <typename T>
+	struct flat_view {
+		static_assert(scts::is_registered_type_v<T>, "flat_view needs a registered type");
+
+		using position = flat_layout::position;
+
+		// Views the root object of a payload, after checking that it was written with the descriptor of T.
+		explicit flat_view(std::string_view payload)
+			: flat_view(payload, flat_layout::root(payload, scts::register_type<T>::descriptor.fingerprint())) { }
+
+		flat_view(std::string_view payload, position table) : m_payload(payload), m_table(table) {
+			constexpr auto member_count = flat_detail::member_count<T>();
+			if (flat_layout::load<position>(payload, table) != member_count) throw schema_mismatch();
+			if (payload.size() - table < sizeof(position) * (1 + member_count)) throw unexpected_end_of_stream();
+		}
+
+		// Reads the member Ptr, which can also be a member of a parent of T.
+		template <auto Ptr>
+		flat_value_t<typename scts::deduce_member_ptr_type<decltype(Ptr)>::type> get() const {
+			constexpr auto slot = flat_detail::slot_of<T, Ptr>();
+			static_assert(slot != flat_detail::npos, "the member is not in the object descriptor of the type");
+			using value_type = typename scts::deduce_member_ptr_type<decltype(Ptr)>::type;
+			const auto at = m_table + sizeof(position) * (1 + slot);
+			return flat_access<value_type>::read(m_payload, flat_layout::follow(m_payload, at));
+		}
+	private:
+		std::string_view m_payload;
+		position m_table;
+	};
+
+	// A view of a vector or an array in the flat layout.
+	template <typename T>
+	struct flat_vector {
+		using position = flat_layout::position;
+		using value_type = flat_value_t<T>;
+
+		struct iterator {
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = flat_vector::value_type;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = value_type;
+
+			value_type operator*() const { return (*m_vector)[m_index]; }
+			iterator& operator++() noexcept { ++m_index; return *this; }
+			iterator operator++(int) noexcept { auto copy = *this; ++m_index; return copy; }
+			bool operator==(const iterator& other) const noexcept { return m_index == other.m_index; }
+			bool operator!=(const iterator& other) const noexcept { return m_index != other.m_index; }
+
+			const flat_vector* m_vector;
+			std::size_t m_index;
+		};
+
+		flat_vector(std::string_view payload, position at) : m_payload(payload), m_elements(at + sizeof(position)) {
+			m_size = flat_layout::load<position>(payload, at);
+			const auto element_size = flat_layout::is_inline<T> ? sizeof(T) : sizeof(position);
+			if (m_size > (payload.size() - m_elements) / element_size) throw unexpected_end_of_stream();
+		}
+
+		std::size_t size() const noexcept { return m_size; }
+		bool empty() const noexcept { return m_size == 0; }
+
+		value_type operator[](std::size_t index) const {
+			if constexpr (flat_layout::is_inline<T>) {
+				return flat_layout::load<T>(m_payload, m_elements + sizeof(T) * index);
+			}
+			else {
+				return flat_access<T>::read(m_payload, flat_layout::follow(m_payload, m_elements + sizeof(position) * index));
+			}
+		}
+
+		iterator begin() const noexcept { return iterator{ this, 0 }; }
+		iterator end() const noexcept { return iterator{ this, m_size }; }
+	private:
+		std::string_view m_payload;
+		std::size_t m_elements;
+		std::size_t m_size;
+	};
+
+	// A view of a map in the flat layout. The keys are in order, so finding one is a binary search.
+	template <typename V>
+	struct flat_map {
+		using position = flat_layout::position;
+
+		flat_map(std::string_view payload, position at) : m_payload(payload), m_pairs(at + sizeof(position)) {
+			m_size = flat_layout::load<position>(payload, at);
+			if (m_size > (payload.size() - m_pairs) / (2 * sizeof(position))) throw unexpected_end_of_stream();
+		}
+
+		std::size_t size() const noexcept { return m_size; }
+		bool empty() const noexcept { return m_size == 0; }
+
+		std::string_view key(std::size_t index) const {
+			return flat_access<std::string>::read(m_payload, flat_layout::follow(m_payload, pair(index)));
+		}
+
+		flat_value_t<V> value(std::size_t index) const {
+			return flat_access<V>::read(m_payload, flat_layout::follow(m_payload, pair(index) + sizeof(position)));
+		}
+
+		std::optional<flat_value_t<V>> find(std::string_view name) const {
+			std::size_t first = 0;
+			std::size_t last = m_size;
+			while (first < last) {
+				const auto middle = first + (last - first) / 2;
+				const auto current = key(middle);
+				if (current == name) return value(middle);
+				if (current < name) first = middle + 1;
+				else last = middle;
+			}
+			return std::nullopt;
+		}
+	private:
+		std::size_t pair(std::size_t index) const noexcept { return m_pairs + 2 * sizeof(position) * index; }
+
+		std::string_view m_payload;
+		std::size_t m_pairs;
+		std::size_t m_size;
+	};
+}
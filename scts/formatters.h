@@ -2,6 +2,10 @@
 
 #include "stream.h"
 
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
 namespace scts {
 	// A dummy formatter that doesn't actually do anything, but documents the formatter interface.
 	// Note that enforcing strong SFINAE here is not really necessary, since this is not a public facing API.
@@ -9,20 +13,50 @@ namespace scts {
 	struct dummy_formatter {
 		static constexpr bool requires_names = true;
 
+		// Optional, formatters that read objects by walking their keys set this to true.
+		static constexpr bool dispatches_by_name = false;
+		// Optional, formatters that can store objects as their raw bytes set this to true.
+		static constexpr bool copies_bulk_objects = false;
+		// Optional, formatters that store the fingerprint of the object descriptor set this to true.
+		static constexpr bool checks_schema = false;
+		// Optional, formatters that identify members by the field numbers of member<> instead of by name set this to true.
+		static constexpr bool uses_field_numbers = false;
+
 		// Reading:
 		// Called before any actual reading happens. Allows you to strip out any wrappers necessary.
 		static void prepare_read(scts::in_stream&) { }
+		// Called after prepare_read with the fingerprint of the object being read. Throws schema_mismatch if the stored
+		// fingerprint is different. Needs to be only available if checks_schema is true.
+		static void check_fingerprint(std::uint64_t, scts::in_stream&) { }
 		// Deserializes a single member from an input stream containing everything that is left to deserialize.
-		// The version taking in a name needs to only be available if requires_names is true.
+		// The version taking in a name needs to only be available if requires_names is true and dispatches_by_name is false.
 		template <typename T>
 		static void read_member(T&, scts::in_stream&) { }
 		template <typename T>
 		static void read_member(T&, scts::in_stream&, const std::string_view&) { }
+		// Reads a whole object, calling the callback with each member name found, with the stream positioned at its value.
+		// The callback reads the member with read_member and returns true, or returns false if there is no such member.
+		// Needs to be only available if dispatches_by_name is true.
+		template <typename Callback>
+		static void read_object(scts::in_stream&, Callback&&) { }
+		// Reads a whole object, calling the callback with each field number found, with the stream positioned at its value.
+		// The callback reads the member with read_member and returns true, or returns false if there is no such member.
+		// Needs to be only available if uses_field_numbers is true.
+		template <typename O, typename Callback>
+		static void read_fields(O&, scts::in_stream&, Callback&&) { }
+		// Reads a whole object whose descriptor is bulk copyable. Needs to be only available if copies_bulk_objects is true.
+		template <typename O>
+		static void read_object_bytes(O&, scts::in_stream&) { }
+		// Applies the members stored by write_delta to an object. Only needed by apply_delta.
+		template <typename O>
+		static void read_delta(O&, scts::in_stream&) { }
 
 		// Writing:
 		// Called before and after writing. Allows you to wrap the serialized data into anything or post-process it.
 		static void prepare_write(scts::out_stream&) { }
 		static void post_write(scts::out_stream&) { }
+		// Called after prepare_write with the fingerprint of the object being written. Needs to be only available if checks_schema is true.
+		static void write_fingerprint(std::uint64_t, scts::out_stream&) { }
 		// Serializes a single member without a name. Needs to be only available if requires_names is false.
 		template <typename T>
 		static scts::out_stream& write_member(const T&, scts::out_stream& stream, bool) {
@@ -33,6 +67,16 @@ namespace scts {
 		static scts::out_stream& write_member(const T&, scts::out_stream& stream, const std::string_view&, bool) {
 			return stream;
 		}
+		// Serializes a single member with its field number. Needs to be only available if uses_field_numbers is true.
+		template <typename T>
+		static void write_field(const T&, scts::out_stream&, std::uint32_t) { }
+		// Writes a whole object whose descriptor is bulk copyable. Needs to be only available if copies_bulk_objects is true.
+		template <typename O>
+		static void write_object_bytes(const O&, scts::out_stream&) { }
+		// Writes the members of the second object that differ from the first, in a form read_delta can apply.
+		// Only needed by serialize_delta.
+		template <typename O>
+		static void write_delta(const O&, const O&, scts::out_stream&) { }
 		// Writes a separator between inherited object members.
 		static void write_inherited_object_separator(scts::out_stream&) { }
 	};
@@ -43,7 +87,46 @@ namespace scts {
 
 	template <typename T>
 	inline constexpr bool is_valid_formatter_v = is_valid_formatter<T>::value;
+
+	template <typename T, typename = void>
+	struct formatter_dispatches_by_name : std::false_type { };
+	template <typename T>
+	struct formatter_dispatches_by_name<T, std::enable_if_t<T::dispatches_by_name>> : std::true_type { };
+
+	template <typename T>
+	inline constexpr bool formatter_dispatches_by_name_v = formatter_dispatches_by_name<T>::value;
+
+	template <typename T, typename = void>
+	struct formatter_copies_bulk_objects : std::false_type { };
+	template <typename T>
+	struct formatter_copies_bulk_objects<T, std::enable_if_t<T::copies_bulk_objects>> : std::true_type { };
+
+	template <typename T>
+	inline constexpr bool formatter_copies_bulk_objects_v = formatter_copies_bulk_objects<T>::value;
+
+	template <typename T, typename = void>
+	struct formatter_checks_schema : std::false_type { };
+	template <typename T>
+	struct formatter_checks_schema<T, std::enable_if_t<T::checks_schema>> : std::true_type { };
+
+	template <typename T>
+	inline constexpr bool formatter_checks_schema_v = formatter_checks_schema<T>::value;
+
+	template <typename T, typename = void>
+	struct formatter_uses_field_numbers : std::false_type { };
+	template <typename T>
+	struct formatter_uses_field_numbers<T, std::enable_if_t<T::uses_field_numbers>> : std::true_type { };
+
+	template <typename T>
+	inline constexpr bool formatter_uses_field_numbers_v = formatter_uses_field_numbers<T>::value;
 }
 
 #include "json_formatter.h"
 #include "binary_formatter.h"
+#include "flat_formatter.h"
+#include "compressed_formatter.h"
+#include "framed_formatter.h"
+#include "msgpack_formatter.h"
+#include "cbor_formatter.h"
+#include "protobuf_formatter.h"
+#include "csv_formatter.h"
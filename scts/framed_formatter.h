@@ -0,0 +1,155 @@
+#pragma once
+
+#include <limits>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <utility>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "stream.h"
+#include "crc32c.h"
+#include "fingerprint.h"
+#include "binary_encoding.h"
+#include "binary_formatter.h"
+
+namespace scts {
+	struct checksum_mismatch : std::exception {
+		const char* what() const noexcept override { return "The checksum of the frame does not match its contents"; }
+	};
+
+	struct invalid_frame : std::exception {
+		invalid_frame(std::size_t position) : m_String("Invalid frame at position " + std::to_string(position)) { }
+		const char* what() const noexcept override { return m_String.c_str(); }
+	private:
+		const std::string m_String;
+	};
+
+	// The format byte of the frames of each binary formatter.
+	template <typename Formatter>
+	struct frame_format;
+
+	template <typename Encoding, binary_layout Layout>
+	struct frame_format<basic_binary_formatter<Encoding, Layout>> {
+		static constexpr std::uint8_t value = static_cast<std::uint8_t>(
+			(std::is_same_v<Encoding, varint_encoding> ? 2 : std::is_same_v<Encoding, little_endian_encoding> ? 1 : 0) |
+			(Layout == binary_layout::columns ? 0x10 : 0));
+	};
+
+	// The frame layout, with all numbers little endian:
+	// - the size of the payload as 32 bits
+	// - the format byte of the formatter and the version byte of the frame layout
+	// - the fingerprint of the descriptor of the object as 64 bits
+	// - the payload
+	// - the CRC-32C of everything after the size
+	struct frame_layout {
+		static constexpr std::uint8_t version = 1;
+		static constexpr std::size_t header_size = sizeof(std::uint32_t) + 2 + sizeof(std::uint64_t);
+		static constexpr std::size_t trailer_size = sizeof(std::uint32_t);
+		static constexpr std::size_t max_payload_size = std::numeric_limits<std::uint32_t>::max();
+
+		// The size of the whole frame at the start of data, or 0 if not even its header is there yet.
+		static std::size_t frame_size(std::string_view data) noexcept {
+			if (data.size() < sizeof(std::uint32_t)) return 0;
+			return header_size + load<std::uint32_t>(data.data()) + trailer_size;
+		}
+
+		template <typename U>
+		static U load(const char* at) noexcept {
+			U value;
+			std::memcpy(&value, at, sizeof(U));
+			return to_little_endian(value);
+		}
+
+		template <typename U>
+		static void store(char* at, U value) noexcept {
+			value = to_little_endian(value);
+			std::memcpy(at, &value, sizeof(U));
+		}
+	};
+
+	// Wraps the payloads of a binary Formatter into frames, which carry the schema fingerprint in their header and a
+	// checksum in their trailer. The checksum is updated after each member as it is written, while its bytes are still
+	// in the cache, instead of in a separate pass over the whole payload. Reading verifies the whole frame before the
+	// payload is parsed, and throws checksum_mismatch, invalid_frame or schema_mismatch.
+	template <typename Formatter>
+	struct framed : Formatter {
+		static constexpr bool checks_schema = true;
+		static constexpr std::uint8_t format = frame_format<Formatter>::value;
+
+		framed(Formatter formatter = Formatter()) : Formatter(std::move(formatter)) { }
+
+		void prepare_write(scts::out_stream& stream) {
+			m_start = stream.size();
+			const auto header = stream.prepare(frame_layout::header_size);
+			std::memset(header, 0, frame_layout::header_size);
+			header[4] = static_cast<char>(format);
+			header[5] = static_cast<char>(frame_layout::version);
+			stream.commit(frame_layout::header_size);
+			m_checksummed = m_start + sizeof(std::uint32_t);
+			m_checksum = 0;
+			Formatter::prepare_write(stream);
+		}
+
+		void write_fingerprint(std::uint64_t fingerprint, scts::out_stream& stream) {
+			frame_layout::store(stream.data() + m_start + 6, fingerprint);
+		}
+
+		template <typename T, typename... Rest>
+		scts::out_stream& write_member(const T& member, scts::out_stream& stream, Rest&&... rest) {
+			Formatter::write_member(member, stream, std::forward<Rest>(rest)...);
+			update_checksum(stream);
+			return stream;
+		}
+
+		template <typename O>
+		void write_object_bytes(const O& object, scts::out_stream& stream) {
+			Formatter::write_object_bytes(object, stream);
+			update_checksum(stream);
+		}
+
+		void post_write(scts::out_stream& stream) {
+			Formatter::post_write(stream);
+			update_checksum(stream);
+			const auto size = stream.size() - m_start - frame_layout::header_size;
+			if (size > frame_layout::max_payload_size) throw std::length_error("frame payloads are limited to 4 GiB");
+			frame_layout::store(stream.data() + m_start, static_cast<std::uint32_t>(size));
+			frame_layout::store(stream.prepare(frame_layout::trailer_size), m_checksum);
+			stream.commit(frame_layout::trailer_size);
+		}
+
+		// Narrows the stream to the payload of the frame at its position.
+		void prepare_read(scts::in_stream& stream) {
+			const auto start = stream.position();
+			const auto size = frame_layout::frame_size(stream.rest());
+			if (size == 0 || size > stream.remaining()) throw unexpected_end_of_stream();
+			stream.advance(sizeof(std::uint32_t));
+			const auto checked = stream.read(size - sizeof(std::uint32_t) - frame_layout::trailer_size);
+			const auto checksum = frame_layout::load<std::uint32_t>(stream.read(frame_layout::trailer_size).data());
+			if (crc32c::compute(checked) != checksum) throw checksum_mismatch();
+			if (static_cast<std::uint8_t>(checked[0]) != format || static_cast<std::uint8_t>(checked[1]) != frame_layout::version) {
+				throw invalid_frame(start + sizeof(std::uint32_t));
+			}
+			m_fingerprint = frame_layout::load<std::uint64_t>(checked.data() + 2);
+			stream = scts::in_stream(checked.substr(frame_layout::header_size - sizeof(std::uint32_t)));
+			Formatter::prepare_read(stream);
+		}
+
+		void check_fingerprint(std::uint64_t expected, scts::in_stream&) const {
+			if (m_fingerprint != expected) throw schema_mismatch();
+		}
+	private:
+		void update_checksum(const scts::out_stream& stream) noexcept {
+			m_checksum = crc32c::update(m_checksum, stream.data() + m_checksummed, stream.size() - m_checksummed);
+			m_checksummed = stream.size();
+		}
+
+		std::size_t m_start = 0;
+		std::size_t m_checksummed = 0;
+		std::uint32_t m_checksum = 0;
+		std::uint64_t m_fingerprint = 0;
+	};
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cassert>
+
 namespace scts {
 	template <typename T>
 	struct deduce_member_ptr_type {
@@ -10,4 +12,20 @@ namespace scts {
 	struct deduce_member_ptr_type<T Parent::*> {
 		using type = T;
 	};
-}
\ No newline at end of file
+
+	// Allocates the object that a raw pointer member is read into. Readers don't own what raw pointers point to,
+	// so the pointer needs to be null before reading, and the caller owns the allocated object afterwards.
+	template <typename T>
+	T& allocate_pointee(T*& pointer) {
+		assert(pointer == nullptr);
+		pointer = new T();
+		return *pointer;
+	}
+
+	// Gives the object a raw pointer member is read over when the value before reading matters, as when applying deltas or
+	// merging repeated fields. Pointers that already point somewhere are read through, and null ones are allocated.
+	template <typename T>
+	T& existing_or_allocated_pointee(T*& pointer) {
+		return pointer != nullptr ? *pointer : allocate_pointee(pointer);
+	}
+}
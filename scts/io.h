@@ -1,63 +1,60 @@
 #pragma once
 
+#include <array>
+#include <utility>
+
 namespace scts {
+	// The members are visited by folding over them together with their indices, instead of peeling one member
+	// per recursive instantiation. That keeps the template depth flat however many members an object has,
+	// and the names are indexed at compile time.
 	template <typename O, typename Names>
 	struct writer {
-		template <typename Formatter, typename Member>
-		static scts::out_stream& write(Formatter& formatter, const O& object, scts::out_stream& stream, const Names& names, std::size_t name_index) {
-			formatter.write_member(Member::get(object), stream, names.at(name_index), true);
+		template <typename Formatter, typename... Members>
+		static scts::out_stream& write(Formatter& formatter, const O& object, scts::out_stream& stream, const Names& names) {
+			write_members<Formatter, Members...>(formatter, object, stream, names, std::index_sequence_for<Members...>{});
 			return stream;
 		}
-
-		template <typename Formatter, typename Member, typename Second, typename... Rest>
-		static scts::out_stream& write(Formatter& formatter, const O& object, scts::out_stream& stream, const Names& names, std::size_t name_index) {
-			formatter.write_member(Member::get(object), stream, names.at(name_index), false);
-			return write<Formatter, Second, Rest...>(formatter, object, stream, names, name_index + 1);
+	private:
+		template <typename Formatter, typename... Members, std::size_t... Indices>
+		static void write_members([[maybe_unused]] Formatter& formatter, [[maybe_unused]] const O& object, [[maybe_unused]] scts::out_stream& stream, [[maybe_unused]] const Names& names, std::index_sequence<Indices...>) {
+			(formatter.write_member(Members::get(object), stream, std::get<Indices>(names), Indices + 1 == sizeof...(Members)), ...);
 		}
 	};
 
 	template <typename O>
 	struct writer_no_names {
-		template <typename Formatter, typename Member>
+		template <typename Formatter, typename... Members>
 		static scts::out_stream& write(Formatter& formatter, const O& object, scts::out_stream& stream) {
-			formatter.write_member(object, stream, true);
+			write_members<Formatter, Members...>(formatter, object, stream, std::index_sequence_for<Members...>{});
 			return stream;
 		}
-
-		template <typename Formatter, typename Member, typename Second, typename... Rest>
-		static scts::out_stream& write(Formatter& formatter, const O& object, scts::out_stream& stream) {
-			formatter.write_member(object, stream, false);
-			return write<Formatter, Second, Rest...>(formatter, object, stream);
+	private:
+		template <typename Formatter, typename... Members, std::size_t... Indices>
+		static void write_members([[maybe_unused]] Formatter& formatter, [[maybe_unused]] const O& object, [[maybe_unused]] scts::out_stream& stream, std::index_sequence<Indices...>) {
+			(formatter.write_member(Members::get(object), stream, Indices + 1 == sizeof...(Members)), ...);
 		}
 	};
 
 	template <typename O, typename Names>
 	struct reader {
-		template <typename Formatter, typename Member>
-		static O& read(Formatter& formatter, O& object, scts::in_stream& stream, const Names& names, std::size_t name_index) {
-			formatter.read_member(Member::get(object), stream, names.at(name_index));
+		template <typename Formatter, typename... Members>
+		static O& read(Formatter& formatter, O& object, scts::in_stream& stream, const Names& names) {
+			read_members<Formatter, Members...>(formatter, object, stream, names, std::index_sequence_for<Members...>{});
 			return object;
 		}
-
-		template <typename Formatter, typename Member, typename Second, typename... Rest>
-		static O& read(Formatter& formatter, O& object, scts::in_stream& stream, const Names& names, std::size_t name_index) {
-			formatter.read_member(Member::get(object), stream, names.at(name_index));
-			return read<Formatter, Second, Rest...>(formatter, object, stream, names, name_index + 1);
+	private:
+		template <typename Formatter, typename... Members, std::size_t... Indices>
+		static void read_members([[maybe_unused]] Formatter& formatter, [[maybe_unused]] O& object, [[maybe_unused]] scts::in_stream& stream, [[maybe_unused]] const Names& names, std::index_sequence<Indices...>) {
+			(formatter.read_member(Members::get(object), stream, std::get<Indices>(names)), ...);
 		}
 	};
 
 	template <typename O>
 	struct reader_no_names {
-		template <typename Formatter, typename Member>
-		static O& read(Formatter& formatter, O& object, scts::in_stream& stream) {
-			formatter.read_member(Member::get(object), stream);
+		template <typename Formatter, typename... Members>
+		static O& read([[maybe_unused]] Formatter& formatter, O& object, [[maybe_unused]] scts::in_stream& stream) {
+			(formatter.read_member(Members::get(object), stream), ...);
 			return object;
 		}
-
-		template <typename Formatter, typename Member, typename Second, typename... Rest>
-		static O& read(Formatter& formatter, O& object, scts::in_stream& stream) {
-			formatter.read_member(Member::get(object), stream);
-			return read<Formatter, Second, Rest...>(formatter, object, stream);
-		}
 	};
-}
\ No newline at end of file
+}
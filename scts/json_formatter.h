@@ -7,6 +7,7 @@ namespace scts {
 	struct json_formatter : json_writer, json_reader { 
 		static constexpr bool requires_names = true;
 
-		constexpr json_formatter(const json_writer::formatting& style = json_writer::compact) : json_writer(style) { }
+		json_formatter(const json_writer::formatting& style = json_writer::compact, json_reader::indexing mode = json_reader::indexing::automatic)
+			: json_writer(style), json_reader(mode) { }
 	};
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "cpu_features.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+namespace scts {
+	// Positions of the structural characters of a JSON document: all quotes, and the braces, brackets, colons and commas
+	// that are outside of strings. Built in one pass over the document, 64 bytes at a time.
+	using structural_index = std::vector<std::uint32_t>;
+
+	struct json_indexer {
+		enum class kernel { scalar, sse2, avx2 };
+
+		static constexpr std::size_t chunk_size = 64;
+		static constexpr std::size_t max_document_size = std::numeric_limits<std::uint32_t>::max();
+
+		static kernel best_kernel() {
+			const auto& features = cpu_features::get();
+			if (features.avx2) return kernel::avx2;
+			if (features.sse2) return kernel::sse2;
+			return kernel::scalar;
+		}
+
+		// Replaces the contents of the index with the structural positions of the document.
+		// Documents longer than max_document_size can not be indexed.
+		static void build(std::string_view json, structural_index& index, kernel selected = best_kernel()) {
+			index.clear();
+			state current;
+			std::size_t position = 0;
+#if defined(SCTS_X86)
+			if (selected == kernel::avx2) position = build_avx2(json, index, current);
+			else if (selected == kernel::sse2) position = build_sse2(json, index, current);
+#endif
+			for (; position + chunk_size <= json.size(); position += chunk_size) {
+				append_chunk(index, position, classify_scalar(json.data() + position), current);
+			}
+
+			if (position < json.size()) {
+				// The last partial chunk is padded with spaces, which are never structural.
+				char padded[chunk_size];
+				std::memset(padded, ' ', chunk_size);
+				std::memcpy(padded, json.data() + position, json.size() - position);
+				append_chunk(index, position, classify_scalar(padded), current);
+			}
+		}
+	private:
+		struct chunk_masks {
+			std::uint64_t quotes;
+			std::uint64_t structurals;
+		};
+
+		struct state {
+			// All ones if the previous chunk ended inside a string.
+			std::uint64_t inside_string = 0;
+		};
+
+		static bool is_structural(char character) {
+			// Setting the 0x20 bit maps '[' to '{' and ']' to '}'.
+			const auto folded = static_cast<char>(character | 0x20);
+			return folded == '{' || folded == '}' || character == ':' || character == ',';
+		}
+
+		static chunk_masks classify_scalar(const char* chunk) {
+			chunk_masks masks{ 0, 0 };
+			for (std::size_t i = 0; i < chunk_size; ++i) {
+				const auto bit = std::uint64_t(1) << i;
+				if (chunk[i] == '"') masks.quotes |= bit;
+				else if (is_structural(chunk[i])) masks.structurals |= bit;
+			}
+			return masks;
+		}
+
+		static void append_chunk(structural_index& index, std::size_t position, chunk_masks masks, state& current) {
+			// A prefix xor over the quote bits marks everything from an opening quote up to its closing quote as inside a string.
+			auto inside = masks.quotes;
+			inside ^= inside << 1;
+			inside ^= inside << 2;
+			inside ^= inside << 4;
+			inside ^= inside << 8;
+			inside ^= inside << 16;
+			inside ^= inside << 32;
+			inside ^= current.inside_string;
+			current.inside_string = static_cast<std::uint64_t>(static_cast<std::int64_t>(inside) >> 63);
+
+			auto structurals = (masks.structurals & ~inside) | masks.quotes;
+			const auto base = static_cast<std::uint32_t>(position);
+			while (structurals != 0) {
+				index.push_back(base + count_trailing_zeros(structurals));
+				structurals &= structurals - 1;
+			}
+		}
+
+#if defined(SCTS_X86)
+		SCTS_TARGET("sse2")
+		static std::size_t build_sse2(std::string_view json, structural_index& index, state& current) {
+			const auto quote = _mm_set1_epi8('"');
+			const auto case_bit = _mm_set1_epi8(0x20);
+			const auto open_brace = _mm_set1_epi8('{');
+			const auto close_brace = _mm_set1_epi8('}');
+			const auto colon = _mm_set1_epi8(':');
+			const auto comma = _mm_set1_epi8(',');
+
+			std::size_t position = 0;
+			for (; position + chunk_size <= json.size(); position += chunk_size) {
+				chunk_masks masks{ 0, 0 };
+				for (int part = 0; part < 4; ++part) {
+					const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(json.data() + position + part * 16));
+					const auto folded = _mm_or_si128(bytes, case_bit);
+					const auto structurals = _mm_or_si128(
+						_mm_or_si128(_mm_cmpeq_epi8(folded, open_brace), _mm_cmpeq_epi8(folded, close_brace)),
+						_mm_or_si128(_mm_cmpeq_epi8(bytes, colon), _mm_cmpeq_epi8(bytes, comma)));
+					const auto shift = part * 16;
+					masks.quotes |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)))) << shift;
+					masks.structurals |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(structurals))) << shift;
+				}
+				append_chunk(index, position, masks, current);
+			}
+			return position;
+		}
+
+		SCTS_TARGET("avx2")
+		static std::size_t build_avx2(std::string_view json, structural_index& index, state& current) {
+			const auto quote = _mm256_set1_epi8('"');
+			const auto case_bit = _mm256_set1_epi8(0x20);
+			const auto open_brace = _mm256_set1_epi8('{');
+			const auto close_brace = _mm256_set1_epi8('}');
+			const auto colon = _mm256_set1_epi8(':');
+			const auto comma = _mm256_set1_epi8(',');
+
+			std::size_t position = 0;
+			for (; position + chunk_size <= json.size(); position += chunk_size) {
+				chunk_masks masks{ 0, 0 };
+				for (int part = 0; part < 2; ++part) {
+					const auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(json.data() + position + part * 32));
+					const auto folded = _mm256_or_si256(bytes, case_bit);
+					const auto structurals = _mm256_or_si256(
+						_mm256_or_si256(_mm256_cmpeq_epi8(folded, open_brace), _mm256_cmpeq_epi8(folded, close_brace)),
+						_mm256_or_si256(_mm256_cmpeq_epi8(bytes, colon), _mm256_cmpeq_epi8(bytes, comma)));
+					const auto shift = part * 32;
+					masks.quotes |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, quote)))) << shift;
+					masks.structurals |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(structurals))) << shift;
+				}
+				append_chunk(index, position, masks, current);
+			}
+			return position;
+		}
+#endif
+	};
+}
@@ -1,235 +1,364 @@
 #pragma once
 
+#include "delta.h"
 #include "stream.h"
+#include "json_index.h"
 #include "lexical_cast.h"
+#include "helpers.h"
 #include "builtin_types.h"
 
-#include <cassert>
+#include <string>
+#include <exception>
+#include <string_view>
 
 namespace scts {
+	struct invalid_json : std::exception {
+		invalid_json(std::size_t position) : m_String("Invalid JSON at position " + std::to_string(position)) { }
+		const char* what() const noexcept override { return m_String.c_str(); }
+	private:
+		const std::string m_String;
+	};
+
+	// Reads JSON in a single forward pass. Object keys are handed to the object descriptor as they are encountered,
+	// which then reads the matching member directly from the stream. Unknown keys are skipped, and members that are
+	// missing from the input are left untouched.
+	// Large documents are first indexed for their structural characters with SIMD, after which strings and skipped
+	// values are passed over by jumping through the index instead of looking at each character.
 	struct json_reader {
+		enum class indexing { never, automatic, always };
+
 		static constexpr bool requires_names = true;
+		static constexpr bool dispatches_by_name = true;
+		static constexpr std::size_t automatic_indexing_threshold = std::size_t(1) << 20;
+
+		explicit json_reader(indexing mode = indexing::automatic) : m_indexing(mode) { }
+
+		void prepare_read(scts::in_stream& stream) {
+			m_use_index = should_index(stream);
+			if (m_use_index) {
+				json_indexer::build(stream.data(), m_structurals);
+				m_next_structural = 0;
+			}
+			skip_whitespace(stream);
+		}
 
-		static void prepare_read(scts::in_stream& stream) {
-			// Strips out containing curly braces and removes all extra whitespace.
-			bool is_inside_string = false;
-			for (std::size_t i = 0; i < stream.length(); ++i) {
-				const auto character = stream.at(i);
-				if (character == '"') {
-					is_inside_string = !is_inside_string;
+		// Reads an object, calling read_named_member(name) for each key with the stream positioned at the value.
+		// The callback returns false if it did not consume the value.
+		template <typename Callback>
+		void read_object(scts::in_stream& stream, Callback&& read_named_member) {
+			expect(stream, '{');
+			if (consume_if(stream, '}')) return;
+			do {
+				skip_whitespace(stream);
+				const auto name = read_string(stream);
+				expect(stream, ':');
+				skip_whitespace(stream);
+				if (!read_named_member(name)) {
+					skip_value(stream);
 				}
-				else if (!is_inside_string && (character == ' ' || character == '\n' || character == '\t')) {
-					stream.erase(i, 1);
-					i--;  // Decrement to counter the increment.
+			} while (consume_if(stream, ','));
+			expect(stream, '}');
+		}
+
+		template <typename T>
+		void read_member(T& member, scts::in_stream& stream) {
+			read_value(member, stream);
+		}
+
+		// A delta written by json_writer::write_delta is an object with only the changed members. Changed objects are deltas
+		// themselves, and so are the elements of sequences of objects given as an object keyed by element index.
+		template <typename O>
+		void read_delta(O& object, scts::in_stream& stream) {
+			delta_member_reader reader{ *this };
+			const auto& descriptor = scts::register_type<O>::descriptor;
+			read_object(stream, [&](std::string_view name) {
+				return descriptor.load_member(reader, object, stream, name);
+			});
+		}
+	private:
+		// Handed to the object descriptor in place of the json_reader, to read the members of a delta as deltas.
+		struct delta_member_reader {
+			json_reader& reader;
+
+			template <typename T>
+			void read_member(T& value, scts::in_stream& stream) {
+				reader.read_value_delta(value, stream);
+			}
+		};
+
+		template <typename T>
+		void read_value_delta(T& value, scts::in_stream& stream) {
+			if constexpr (is_registered_type_v<T>) {
+				read_delta(value, stream);
+			}
+			else if constexpr (is_object_sequence_v<T>) {
+				skip_whitespace(stream);
+				if (stream.empty() || stream.peek() != '{') {
+					read_value(value, stream);
+					return;
 				}
+				read_object(stream, [&](std::string_view key) {
+					const auto index = parse_number<std::size_t>(key);
+					if (index >= std::size(value)) throw invalid_json(stream.position());
+					read_delta(*(std::begin(value) + index), stream);
+					return true;
+				});
+			}
+			else if constexpr (std::is_pointer_v<T>) {
+				// The object already points to the pointee of the previous snapshot, so it is read over instead.
+				if (read_null(stream)) value = nullptr;
+				else read_value(scts::existing_or_allocated_pointee(value), stream);
 			}
+			else {
+				read_value(value, stream);
+			}
+		}
 
-			const auto starts_with_brace = stream.front() == '{';
-			const auto ends_with_brace = stream.back() == '}';
-			assert(starts_with_brace && ends_with_brace);
-			stream = stream.substr(1, stream.length() - 2);
+		bool should_index(const scts::in_stream& stream) const {
+			if (stream.size() > json_indexer::max_document_size) return false;
+			return m_indexing == indexing::always ||
+				(m_indexing == indexing::automatic && stream.remaining() >= automatic_indexing_threshold);
 		}
 
-		template <typename T>
-		static void read_member(T& member, scts::in_stream& stream, const std::string_view& name) {
-			const auto content = read_next_section_and_consume_stream_with_name(stream, name);
-			if (content.has_value()) {
-				read_value(member, content.value());
+		// Returns the position of the next structural character at or after the stream position, or the stream size.
+		std::size_t next_structural(const scts::in_stream& stream) {
+			while (m_next_structural < m_structurals.size() && m_structurals[m_next_structural] < stream.position()) {
+				m_next_structural++;
 			}
+			return m_next_structural < m_structurals.size() ? m_structurals[m_next_structural] : stream.size();
 		}
-	private:
-		static std::string remove_quotes_from_string(const scts::in_stream& stream) {
-			const auto has_quotes = stream.front() == '"' && stream.back() == '"';
-			assert(has_quotes);
-			return stream.substr(1, stream.length() - 2);
+
+		static bool is_whitespace(char character) {
+			return character == ' ' || character == '\n' || character == '\t' || character == '\r';
+		}
+
+		static bool is_value_end(char character) {
+			return character == ',' || character == '}' || character == ']' || is_whitespace(character);
+		}
+
+		static void skip_whitespace(scts::in_stream& stream) {
+			while (!stream.empty() && is_whitespace(stream.peek())) stream.advance(1);
 		}
 
-		static std::optional<scts::in_stream> read_next_section_and_consume_stream_with_name(scts::in_stream& stream, const std::string_view& name) {
-			const auto search_for = '"' + std::string(name) + '"' + ":";
-			const auto name_start = stream.find(search_for);
-			if (name_start == std::string::npos) {
-				return std::nullopt;
+		// Skips whitespace, and consumes the next character if it is the expected one.
+		static bool consume_if(scts::in_stream& stream, char expected) {
+			skip_whitespace(stream);
+			if (!stream.empty() && stream.peek() == expected) {
+				stream.advance(1);
+				return true;
 			}
-			const auto name_end = name_start + search_for.length();
-			return read_next_section_and_consume_stream(stream, name_end, search_for.length());
+			return false;
 		}
 
-		static scts::in_stream read_next_section_and_consume_stream(scts::in_stream& stream, std::size_t start, std::size_t name_length) {
-			const std::size_t comma_position = [&]() {
+		static void expect(scts::in_stream& stream, char expected) {
+			if (!consume_if(stream, expected)) throw invalid_json(stream.position());
+		}
+
+		// Reads the contents of a string, without the quotes.
+		std::string_view read_string(scts::in_stream& stream) {
+			expect(stream, '"');
+			const auto rest = stream.rest();
+			const auto end = m_use_index ? next_structural(stream) - stream.position() : rest.find('"');
+			if (end >= rest.size()) throw unexpected_end_of_stream();
+			stream.advance(end + 1);
+			return rest.substr(0, end);
+		}
+
+		// Reads a number or a literal, that ends at the first whitespace or structural character.
+		std::string_view read_token(scts::in_stream& stream) {
+			const auto rest = stream.rest();
+			std::size_t end = 0;
+			if (m_use_index) {
+				end = next_structural(stream) - stream.position();
+				while (end > 0 && is_whitespace(rest[end - 1])) end--;
+			}
+			else {
+				while (end < rest.size() && !is_value_end(rest[end])) end++;
+			}
+			stream.advance(end);
+			return rest.substr(0, end);
+		}
+
+		// Consumes a null literal if there is one.
+		bool read_null(scts::in_stream& stream) {
+			if (stream.peek() != 'n') return false;
+			if (read_token(stream) != "null") throw invalid_json(stream.position());
+			return true;
+		}
+
+		void skip_value(scts::in_stream& stream) {
+			const auto first = stream.peek();
+			if (first == '"') {
+				read_string(stream);
+			}
+			else if (first == '{' || first == '[') {
 				std::size_t open_braces = 0;
-				bool is_inside_string = false;
-				for (std::size_t i = start; i < stream.length(); ++i) {
-					const auto current = stream.at(i);
-					if (!is_inside_string && current == ',' && open_braces == 0) {
-						return i;
+				do {
+					if (m_use_index) {
+						// Strings never need to be looked at here, as their contents are not in the index.
+						const auto next = next_structural(stream);
+						if (next >= stream.size()) throw unexpected_end_of_stream();
+						stream.seek(next);
 					}
-					else if (current == '"') {
-						is_inside_string = !is_inside_string;
+					const auto current = stream.get();
+					if (current == '"' && !m_use_index) {
+						stream.seek(stream.position() - 1);
+						read_string(stream);
 					}
-					else if (!is_inside_string && (current == '{' || current == '[')) {
+					else if (current == '{' || current == '[') {
 						open_braces++;
 					}
-					else if (!is_inside_string && (current == '}' || current == ']')) {
-						assert(open_braces > 0);
+					else if (current == '}' || current == ']') {
 						open_braces--;
 					}
-				}
-				return scts::in_stream::npos;
-			}();
-
-			if (comma_position == scts::in_stream::npos) {
-				const auto copy = stream.substr(start);
-				stream.erase(start - name_length, std::string::npos);
-				return copy;
+				} while (open_braces > 0);
+			}
+			else {
+				read_token(stream);
 			}
+		}
 
-			const auto section = stream.substr(start, comma_position - start);
-			stream.erase(start - name_length, comma_position - start + name_length + 1);
-			return section;
+		// Reads a list, calling read_element() with the stream positioned at each element.
+		template <typename Callback>
+		void read_list(scts::in_stream& stream, Callback&& read_element) {
+			expect(stream, '[');
+			if (consume_if(stream, ']')) return;
+			do {
+				skip_whitespace(stream);
+				read_element();
+			} while (consume_if(stream, ','));
+			expect(stream, ']');
 		}
 
+		// Strings, booleans and arithmetic types.
 		template <typename T, typename = void>
 		struct builtin_type_reader {
-			static void read(T& value, const scts::in_stream& stream) {
-				value = convert_stream_to_value<T>(stream);
-			}
-		private:
-			template <typename V, typename = void>
-			static V convert_stream_to_value(const scts::in_stream& stream) {
-				return lexical_cast<T>(stream);
-			}
-			template <>
-			static bool convert_stream_to_value<bool>(const scts::in_stream& stream) {
-				return stream == "true";
-			}
-			template <>
-			static std::string convert_stream_to_value<std::string>(const scts::in_stream& stream) {
-				return remove_quotes_from_string(stream);
+			static void read(json_reader& reader, T& value, scts::in_stream& stream) {
+				if constexpr (std::is_same_v<T, bool>) {
+					const auto token = reader.read_token(stream);
+					if (token != "true" && token != "false") throw invalid_json(stream.position());
+					value = token == "true";
+				}
+				else if constexpr (std::is_same_v<T, std::string>) {
+					value = std::string(reader.read_string(stream));
+				}
+				else if constexpr (std::is_same_v<T, char>) {
+					// Plain chars are written as the character itself.
+					const auto token = reader.read_token(stream);
+					if (token.size() != 1) throw invalid_json(stream.position());
+					value = token.front();
+				}
+				else {
+					value = parse_number<T>(reader.read_token(stream));
+				}
 			}
 		};
 
-		static void prepare_stream_for_list_processing(scts::in_stream& stream) {
-			const bool has_array_braces = stream.front() == '[' && stream.back() == ']';
-			assert(has_array_braces);
-			stream = stream.substr(1, stream.length() - 2);
-		}
-
 		template <typename T>
 		struct builtin_type_reader<std::vector<T>> {
-			static void read(std::vector<T>& vector, const scts::in_stream& stream) {
+			static void read(json_reader& reader, std::vector<T>& vector, scts::in_stream& stream) {
 				vector.clear();
-				auto copy = stream;
-				prepare_stream_for_list_processing(copy);
-				while (!copy.empty()) {
-					const auto section = read_next_section_and_consume_stream(copy, 0, 0);
+				reader.read_list(stream, [&]() {
 					T value{};
-					read_value(value, section);
-					vector.push_back(value);
-				}
+					reader.read_value(value, stream);
+					vector.push_back(std::move(value));
+				});
 			}
 		};
 
 		template <typename T, std::size_t C>
 		struct builtin_type_reader<std::array<T, C>> {
-			static void read(std::array<T, C>& array, const scts::in_stream& stream) {
-				auto copy = stream;
-				prepare_stream_for_list_processing(copy);
-				for (std::size_t i = 0; i < array.size(); ++i) {
-					const auto section = read_next_section_and_consume_stream(copy, 0, 0);
-					read_value(array.at(i), section);
-				}
+			static void read(json_reader& reader, std::array<T, C>& array, scts::in_stream& stream) {
+				std::size_t index = 0;
+				reader.read_list(stream, [&]() {
+					if (index < C) reader.read_value(array[index++], stream);
+					else reader.skip_value(stream);
+				});
 			}
 		};
 
 		template <typename V>
 		struct builtin_type_reader<std::map<std::string, V>> {
-			static void read(std::map<std::string, V>& map, const scts::in_stream& stream) {
+			static void read(json_reader& reader, std::map<std::string, V>& map, scts::in_stream& stream) {
 				map.clear();
-				auto copy = stream;
-				prepare_read(copy);
-				while (!copy.empty()) {
-					const auto name_end = copy.find(":");
-					const auto name_source = copy.substr(0, name_end);
-					copy.erase(0, name_end + 1);
-					const auto name = remove_quotes_from_string(name_source);
-					const auto section = read_next_section_and_consume_stream(copy, 0, 0);
+				reader.read_object(stream, [&](std::string_view name) {
 					V value{};
-					read_value(value, section);
-					map.insert(std::make_pair(name, value));
-				}
+					reader.read_value(value, stream);
+					map.insert(std::make_pair(std::string(name), std::move(value)));
+					return true;
+				});
 			}
 		};
 
 		template <typename Enum>
 		struct builtin_type_reader<Enum, typename std::enable_if_t<std::is_enum_v<Enum>>> {
-			static void read(Enum& value, const scts::in_stream& stream) {
-				value = static_cast<Enum>(std::stoi(stream));
+			static void read(json_reader& reader, Enum& value, scts::in_stream& stream) {
+				value = static_cast<Enum>(parse_number<std::underlying_type_t<Enum>>(reader.read_token(stream)));
 			}
 		};
 
 		template <typename T>
 		struct builtin_type_reader<T*> {
-			static void read(T*& value, const scts::in_stream& stream) {
-				if (stream == "null") {
+			static void read(json_reader& reader, T*& value, scts::in_stream& stream) {
+				if (reader.read_null(stream)) {
 					value = nullptr;
 				}
 				else {
-					assert(value == nullptr);  // TODO: Decide how to handle memory allocation inside the serializer.
-					value = new T();
-					read_value(*value, stream);
+					reader.read_value(scts::allocate_pointee(value), stream);
 				}
 			}
 		};
 
 		template <typename T, std::size_t C>
 		struct builtin_type_reader<T[C]> {
-			static void read(T(&array)[C], const scts::in_stream& stream) {
-				auto copy = stream;
-				prepare_stream_for_list_processing(copy);
-				for (std::size_t i = 0; i < C; ++i) {
-					const auto section = read_next_section_and_consume_stream(copy, 0, 0);
-					read_value(array[i], section);
-				}
+			static void read(json_reader& reader, T(&array)[C], scts::in_stream& stream) {
+				std::size_t index = 0;
+				reader.read_list(stream, [&]() {
+					if (index < C) reader.read_value(array[index++], stream);
+					else reader.skip_value(stream);
+				});
 			}
 		};
 
 		template <typename T>
 		struct builtin_type_reader<std::optional<T>> {
-			static void read(std::optional<T>& value, const scts::in_stream& stream) {
-				if (stream == "null") {
+			static void read(json_reader& reader, std::optional<T>& value, scts::in_stream& stream) {
+				if (reader.read_null(stream)) {
 					value = std::nullopt;
 				}
 				else {
 					value = T{};
-					read_value(value.value(), stream);
+					reader.read_value(value.value(), stream);
 				}
 			}
 		};
 
 		template <typename T>
 		struct builtin_type_reader<std::unique_ptr<T>> {
-			static void read(std::unique_ptr<T>& value, const scts::in_stream& stream) {
-				if (stream == "null") {
+			static void read(json_reader& reader, std::unique_ptr<T>& value, scts::in_stream& stream) {
+				if (reader.read_null(stream)) {
 					value = nullptr;
 				}
 				else {
 					value = std::make_unique<T>();
-					read_value(*value.get(), stream);  // Dereferences because the pointer pipeline currently manages memory.
+					reader.read_value(*value.get(), stream);  // Dereferences because the pointer pipeline currently manages memory.
 				}
 			}
 		};
 
 		template <typename T>
-		static typename std::enable_if<is_builtin_type<T>::value, void>::type read_value(T& member, const scts::in_stream& stream) {
-			return builtin_type_reader<T>::template read(member, stream);
+		typename std::enable_if<is_builtin_type<T>::value, void>::type read_value(T& member, scts::in_stream& stream) {
+			builtin_type_reader<T>::read(*this, member, stream);
 		}
 
 		template <typename T>
-		static typename std::enable_if<!is_builtin_type<T>::value, void>::type read_value(T& member, const scts::in_stream& stream) {
-			auto copy = stream;
-			prepare_read(copy);
-			auto formatter = json_reader{};
-			scts::register_type<T>::descriptor.load(formatter, member, copy);
+		typename std::enable_if<!is_builtin_type<T>::value, void>::type read_value(T& member, scts::in_stream& stream) {
+			scts::register_type<T>::descriptor.load(*this, member, stream);
 		}
+
+		indexing m_indexing;
+		bool m_use_index = false;
+		structural_index m_structurals;
+		std::size_t m_next_structural = 0;
 	};
-}
\ No newline at end of file
+}
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "delta.h"
 #include "stream.h"
 #include "builtin_types.h"
 
+#include <bitset>
 #include <string>
+#include <cstdint>
 
 namespace scts {
 	struct json_writer {
@@ -12,7 +15,7 @@ namespace scts {
 			const std::string_view indentation;
 		};
 
-		static constexpr formatting compact = formatting{};
+		static constexpr formatting compact = formatting{ false, "" };
 		static constexpr formatting pretty_with_tabs = formatting{ true, "\t" };
 		static constexpr formatting pretty_with_4spaces = formatting{ true, "    " };
 
@@ -32,15 +35,58 @@ namespace scts {
 		scts::out_stream& write_member(const T& value, scts::out_stream& stream, const std::string_view& name, bool is_last) {
 			static_assert(scts::is_serializable_v<T>);
 
-			write_indentation(stream);
-			write_wrapped_in_quotes(name, stream) << ":";
-			if (m_formatting.pretty) stream << " ";
+			write_name(name, stream);
 			return write_value(value, stream, is_last);
 		}
 
 		static void write_inherited_object_separator(scts::out_stream& stream) {
 			stream << ",";
 		}
+
+		// Writes only the members of current that differ from previous, with changed objects written as deltas themselves.
+		// Sequences of objects that kept their length are written as an object of their changed elements, keyed by index,
+		// while those that changed length are written whole, as are other containers.
+		// Reading the result into previous gives current, since json_reader leaves missing members untouched.
+		template <typename O>
+		void write_delta(const O& previous, const O& current, scts::out_stream& stream) {
+			const auto& descriptor = scts::register_type<O>::descriptor;
+			std::bitset<std::decay_t<decltype(descriptor)>::member_count> changed;
+			std::size_t index = 0;
+			descriptor.for_each_named_member([&](auto member, std::string_view) {
+				using member_type = decltype(member);
+				changed[index++] = !values_equal(member_type::get(previous), member_type::get(current));
+			});
+			auto remaining = changed.count();
+			index = 0;
+			descriptor.for_each_named_member([&](auto member, std::string_view name) {
+				using member_type = decltype(member);
+				using value_type = typename member_type::value_type;
+				if (!changed[index++]) return;
+				const bool is_last = --remaining == 0;
+				const auto& before = member_type::get(previous);
+				const auto& after = member_type::get(current);
+				if constexpr (is_registered_type_v<value_type>) {
+					write_name(name, stream);
+					start_subobject(stream);
+					write_delta(before, after, stream);
+					end_subobject(stream);
+					write_separator_if_required(stream, is_last);
+				}
+				else if constexpr (is_object_sequence_v<value_type>) {
+					if (std::size(before) == std::size(after)) {
+						write_name(name, stream);
+						write_elements_delta(std::begin(before), std::begin(after), std::size(after), stream);
+						write_separator_if_required(stream, is_last);
+					}
+					else {
+						write_member(after, stream, name, is_last);
+					}
+				}
+				else {
+					write_member(after, stream, name, is_last);
+				}
+			});
+		}
 	private:
 		template <typename T>
 		typename std::enable_if<is_builtin_type<T>::value, scts::out_stream&>::type write_value(const T& value, scts::out_stream& stream, bool is_last) {
@@ -55,6 +101,31 @@ namespace scts {
 			return write_separator_if_required(stream, is_last);
 		}
 
+		// Writes the changed elements of a sequence of objects as deltas, in an object keyed by their index.
+		template <typename Iterator>
+		void write_elements_delta(Iterator previous, Iterator current, std::size_t count, scts::out_stream& stream) {
+			start_subobject(stream);
+			bool first = true;
+			for (std::size_t i = 0; i < count; ++i, ++previous, ++current) {
+				if (values_equal(*previous, *current)) continue;
+				if (!first) write_separator_if_required(stream, false);
+				first = false;
+				write_indentation(stream);
+				stream << '"' << i << "\":";
+				if (m_formatting.pretty) stream << " ";
+				start_subobject(stream);
+				write_delta(*previous, *current, stream);
+				end_subobject(stream);
+			}
+			end_subobject(stream);
+		}
+
+		void write_name(std::string_view name, scts::out_stream& stream) {
+			write_indentation(stream);
+			write_wrapped_in_quotes(name, stream) << ":";
+			if (m_formatting.pretty) stream << " ";
+		}
+
 		template <typename StringLike>
 		static scts::out_stream& write_wrapped_in_quotes(const StringLike& value, scts::out_stream& stream) {
 			stream << '"' << value << '"';
@@ -118,15 +189,20 @@ namespace scts {
 				return writer.write_separator_if_required(stream, is_last);
 			}
 		private:
-			template <typename T> static void write(const T& value, scts::out_stream& stream) { stream << value; }
-			template <> static void write<int8_t>(const int8_t& value, scts::out_stream& stream) { stream << static_cast<int>(value); }
-			template <> static void write<uint8_t>(const uint8_t& value, scts::out_stream& stream) { stream << static_cast<int>(value); }
-			template <> static void write<bool>(const bool& value, scts::out_stream& stream) {
-				if (value) stream << "true";
-				else stream << "false";
-			}
-			template <> static void write<std::string>(const std::string& value, scts::out_stream& stream) {
-				write_wrapped_in_quotes(value, stream);
+			static void write(const T& value, scts::out_stream& stream) {
+				if constexpr (std::is_same_v<T, bool>) {
+					if (value) stream << "true";
+					else stream << "false";
+				}
+				else if constexpr (std::is_same_v<T, std::int8_t> || std::is_same_v<T, std::uint8_t>) {
+					stream << static_cast<int>(value);
+				}
+				else if constexpr (std::is_same_v<T, std::string>) {
+					write_wrapped_in_quotes(value, stream);
+				}
+				else {
+					stream << value;
+				}
 			}
 		};
 
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <string>
 #include <sstream>
+#include <charconv>
+#include <system_error>
+#include <string_view>
 #include <cstdint>
 #include <exception>
 #include <type_traits>
@@ -8,7 +12,7 @@
 namespace scts {
 	struct invalid_lexical_cast : std::exception {
 		invalid_lexical_cast(const std::string& string) : m_String("Invalid lexical_cast source: " + string) { }
-		const char* what() const override { return m_String.c_str(); }
+		const char* what() const noexcept override { return m_String.c_str(); }
 	private:
 		const std::string m_String;
 	};
@@ -52,4 +56,18 @@ namespace scts {
 	inline typename std::enable_if<std::is_arithmetic<T>::value, T>::type lexical_cast(const StringLike& source) {
 		return lexical_caster<T>::cast(source);
 	}
+
+	// Parses a number straight from its characters with std::from_chars: independent of locales and without allocating.
+	// Unlike lexical_cast, the whole source needs to be the number, and values out of range for T are rejected.
+	// Parsing floating point numbers is exact, so numbers written with the shortest round trip representation read back identically.
+	template <typename T>
+	inline typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, T>::type parse_number(std::string_view source) {
+		T value{};
+		const auto end = source.data() + source.size();
+		const auto result = std::from_chars(source.data(), end, value);
+		if (result.ec != std::errc() || result.ptr != end) {
+			throw invalid_lexical_cast(std::string(source));
+		}
+		return value;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <string_view>
+
+#include "cpu_features.h"
+#include "binary_encoding.h"
+
+namespace scts {
+	struct invalid_compressed_data : std::exception {
+		invalid_compressed_data(std::size_t position) : m_String("Invalid compressed data at position " + std::to_string(position)) { }
+		const char* what() const noexcept override { return m_String.c_str(); }
+	private:
+		const std::string m_String;
+	};
+
+	// A small LZ77 family codec for independent blocks, with the same sequence layout as LZ4.
+	// A block is a list of sequences, each of them a token byte followed by literals and a match:
+	// - the high four bits of the token are the count of literals, the low four bits the length of the match minus four
+	// - a count of 15 continues in the following bytes, which are added to it until one of them is not 255
+	// - the literals are copied as they are
+	// - the match is a 16-bit little endian offset back into the output, followed by the continuation of its length
+	// The last sequence ends the block right after its literals and has no match.
+	struct lz_codec {
+		static constexpr std::size_t min_match = 4;
+		static constexpr std::size_t max_offset = 65535;
+		static constexpr unsigned hash_bits = 14;
+		static constexpr std::size_t hash_table_size = std::size_t(1) << hash_bits;
+
+		// Compresses size bytes of input into output, which has room for capacity bytes. The table needs hash_table_size entries.
+		// Returns the compressed size, or 0 if the result would not fit, in which case the block is better stored as it is.
+		static std::size_t compress(const char* input, std::size_t size, char* output, std::size_t capacity, std::uint32_t* table) {
+			std::memset(table, 0, hash_table_size * sizeof(std::uint32_t));
+			auto out = output;
+			const auto out_end = output + capacity;
+			std::size_t anchor = 0;
+			std::size_t position = 0;
+			// Skips ahead faster the longer no match is found, so incompressible data passes quickly.
+			std::size_t misses = 0;
+
+			while (size >= min_match && position <= size - min_match) {
+				const auto sequence = load32(input + position);
+				const auto slot = hash(sequence);
+				auto candidate = static_cast<std::size_t>(table[slot]);
+				table[slot] = static_cast<std::uint32_t>(position);
+
+				if (candidate >= position || position - candidate > max_offset || load32(input + candidate) != sequence) {
+					position += 1 + (misses++ >> 5);
+					continue;
+				}
+
+				while (position > anchor && candidate > 0 && input[position - 1] == input[candidate - 1]) {
+					--position;
+					--candidate;
+				}
+				const auto length = min_match + match_length(input + position + min_match, input + candidate + min_match, input + size);
+				out = write_sequence(out, out_end, input + anchor, position - anchor, position - candidate, length);
+				if (out == nullptr) return 0;
+
+				position += length;
+				anchor = position;
+				misses = 0;
+			}
+
+			if (anchor < size) {
+				out = write_literals(out, out_end, input + anchor, size - anchor);
+				if (out == nullptr) return 0;
+			}
+			return static_cast<std::size_t>(out - output);
+		}
+
+		// Decompresses a whole block into output, which has room for capacity bytes. Returns the decompressed size.
+		// Throws invalid_compressed_data if the block is malformed or does not fit, reporting the position within input.
+		static std::size_t decompress(std::string_view input, char* output, std::size_t capacity) {
+			const auto begin = input.data();
+			auto in = begin;
+			const auto in_end = begin + input.size();
+			std::size_t produced = 0;
+
+			while (in != in_end) {
+				const auto token = static_cast<std::uint8_t>(*in++);
+
+				const auto literals = read_length(in, in_end, token >> 4, begin);
+				if (literals > static_cast<std::size_t>(in_end - in) || literals > capacity - produced) throw invalid_compressed_data(static_cast<std::size_t>(in - begin));
+				std::memcpy(output + produced, in, literals);
+				in += literals;
+				produced += literals;
+				if (in == in_end) break;
+
+				if (in_end - in < 2) throw invalid_compressed_data(static_cast<std::size_t>(in - begin));
+				const auto offset = static_cast<std::size_t>(static_cast<std::uint8_t>(in[0])) | (static_cast<std::size_t>(static_cast<std::uint8_t>(in[1])) << 8);
+				if (offset == 0 || offset > produced) throw invalid_compressed_data(static_cast<std::size_t>(in - begin));
+				in += 2;
+
+				const auto length = min_match + read_length(in, in_end, token & 15, begin);
+				if (length > capacity - produced) throw invalid_compressed_data(static_cast<std::size_t>(in - begin));
+				copy_match(output + produced, offset, length);
+				produced += length;
+			}
+			return produced;
+		}
+	private:
+		static std::uint32_t load32(const char* bytes) noexcept {
+			std::uint32_t value;
+			std::memcpy(&value, bytes, sizeof(value));
+			return value;
+		}
+
+		static std::size_t hash(std::uint32_t sequence) noexcept {
+			return static_cast<std::size_t>((sequence * 2654435761u) >> (32 - hash_bits));
+		}
+
+		// Counts the matching bytes, eight at a time where the lowest differing bit tells the first differing byte.
+		static std::size_t match_length(const char* current, const char* candidate, const char* end) noexcept {
+			const auto start = current;
+			if constexpr (host_is_little_endian) {
+				while (end - current >= 8) {
+					std::uint64_t a, b;
+					std::memcpy(&a, current, 8);
+					std::memcpy(&b, candidate, 8);
+					if (a != b) return static_cast<std::size_t>(current - start) + count_trailing_zeros(a ^ b) / 8;
+					current += 8;
+					candidate += 8;
+				}
+			}
+			while (current != end && *current == *candidate) {
+				++current;
+				++candidate;
+			}
+			return static_cast<std::size_t>(current - start);
+		}
+
+		static std::size_t length_extension_size(std::size_t length) noexcept {
+			return length < 15 ? 0 : (length - 15) / 255 + 1;
+		}
+
+		static char* write_length_extension(char* out, std::size_t length) noexcept {
+			if (length < 15) return out;
+			length -= 15;
+			for (; length >= 255; length -= 255) *out++ = static_cast<char>(255);
+			*out++ = static_cast<char>(length);
+			return out;
+		}
+
+		static char* write_literals(char* out, const char* out_end, const char* literals, std::size_t count) noexcept {
+			if (static_cast<std::size_t>(out_end - out) < 1 + length_extension_size(count) + count) return nullptr;
+			*out++ = static_cast<char>((count < 15 ? count : 15) << 4);
+			out = write_length_extension(out, count);
+			std::memcpy(out, literals, count);
+			return out + count;
+		}
+
+		static char* write_sequence(char* out, const char* out_end, const char* literals, std::size_t count, std::size_t offset, std::size_t length) noexcept {
+			const auto extra = length - min_match;
+			if (static_cast<std::size_t>(out_end - out) < 1 + length_extension_size(count) + count + 2 + length_extension_size(extra)) return nullptr;
+			*out++ = static_cast<char>(((count < 15 ? count : 15) << 4) | (extra < 15 ? extra : 15));
+			out = write_length_extension(out, count);
+			std::memcpy(out, literals, count);
+			out += count;
+			*out++ = static_cast<char>(offset & 0xff);
+			*out++ = static_cast<char>(offset >> 8);
+			return write_length_extension(out, extra);
+		}
+
+		static std::size_t read_length(const char*& in, const char* in_end, std::size_t length, const char* begin) {
+			if (length != 15) return length;
+			std::uint8_t byte;
+			do {
+				if (in == in_end) throw invalid_compressed_data(static_cast<std::size_t>(in - begin));
+				byte = static_cast<std::uint8_t>(*in++);
+				length += byte;
+			} while (byte == 255);
+			return length;
+		}
+
+		// Matches may overlap what they produce, which repeats the last offset bytes.
+		static void copy_match(char* out, std::size_t offset, std::size_t length) noexcept {
+			const auto source = out - offset;
+			if (offset >= length) {
+				std::memcpy(out, source, length);
+			}
+			else {
+				for (std::size_t i = 0; i < length; ++i) out[i] = source[i];
+			}
+		}
+	};
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string_view>
+
+#include "stream.h"
+#include "serializer.h"
+#include "formatters.h"
+#include "register_type.h"
+#include "descriptor_io.h"
+
+namespace scts {
+	// Writes registered objects to a file descriptor, each as a frame of framed<Formatter>.
+	// The buffer the frames are serialized into is reused across messages. The descriptor is not closed.
+	template <typename Formatter = scts::binary_formatter>
+	struct message_writer {
+		explicit message_writer(int descriptor, Formatter formatter = Formatter()) : m_descriptor(descriptor), m_formatter(std::move(formatter)) { }
+
+		template <typename O>
+		void write(const O& object) {
+			m_buffer.clear();
+			scts::serialize(object, m_buffer, m_formatter);
+			descriptor_io::write_all(m_descriptor, m_buffer.data(), m_buffer.size());
+		}
+	private:
+		int m_descriptor;
+		scts::framed<Formatter> m_formatter;
+		scts::out_stream m_buffer;
+	};
+
+	// Reads the objects written by message_writer back one at a time, however the input arrives in pieces.
+	// A frame that fails its checksum is dropped, and read throws checksum_mismatch for it, after which reading goes on
+	// with the next frame. Where no frame header could start, such as after a damaged size, bytes are skipped until one can.
+	template <typename Formatter = scts::binary_formatter>
+	struct message_reader {
+		static constexpr std::size_t default_max_message_size = std::size_t(64) << 20;
+		static constexpr std::size_t read_size = std::size_t(64) << 10;
+
+		explicit message_reader(int descriptor, Formatter formatter = Formatter(), std::size_t max_message_size = default_max_message_size)
+			: m_descriptor(descriptor), m_formatter(std::move(formatter)), m_max_message_size(max_message_size) { }
+
+		// Reads the next message into object. Returns false if the input ended right after the previous message,
+		// and throws unexpected_end_of_stream if it ended within one.
+		template <typename O>
+		bool read(O& object) {
+			for (;;) {
+				const auto available = m_buffer.view().substr(m_begin);
+				if (available.size() >= frame_layout::header_size && !plausible_header(available)) {
+					++m_begin;
+					++m_skipped;
+					continue;
+				}
+				const auto size = frame_layout::frame_size(available);
+				if (available.size() >= frame_layout::header_size && available.size() >= size) {
+					m_begin += size;
+					scts::deserialize(object, scts::in_stream(available.substr(0, size)), m_formatter);
+					return true;
+				}
+				if (!fill(available.size() < frame_layout::header_size ? frame_layout::header_size : size)) {
+					if (available.empty()) return false;
+					throw unexpected_end_of_stream();
+				}
+			}
+		}
+
+		// The amount of bytes that were skipped to find the start of a frame.
+		std::size_t skipped() const noexcept { return m_skipped; }
+	private:
+		bool plausible_header(std::string_view available) const noexcept {
+			return static_cast<std::uint8_t>(available[4]) == framed<Formatter>::format &&
+				static_cast<std::uint8_t>(available[5]) == frame_layout::version &&
+				frame_layout::frame_size(available) <= m_max_message_size;
+		}
+
+		// Reads more input until at least needed bytes are buffered after m_begin. Returns false at the end of the input.
+		bool fill(std::size_t needed) {
+			const auto buffered = m_buffer.size() - m_begin;
+			if (m_begin > 0) {
+				std::memmove(m_buffer.data(), m_buffer.data() + m_begin, buffered);
+				m_buffer.truncate(buffered);
+				m_begin = 0;
+			}
+			const auto count = std::max(needed - buffered, read_size);
+			const auto read = descriptor_io::read_some(m_descriptor, m_buffer.prepare(count), count);
+			m_buffer.commit(read);
+			return read > 0;
+		}
+
+		int m_descriptor;
+		scts::framed<Formatter> m_formatter;
+		std::size_t m_max_message_size;
+		scts::out_stream m_buffer;
+		std::size_t m_begin = 0;
+		std::size_t m_skipped = 0;
+	};
+}
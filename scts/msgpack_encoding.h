@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <exception>
+
+#include "stream.h"
+#include "value_as_binary.h"
+#include "binary_encoding.h"
+
+namespace scts {
+	struct invalid_msgpack : std::exception {
+		invalid_msgpack(std::size_t position) : m_String("Invalid MessagePack at position " + std::to_string(position)) { }
+		const char* what() const noexcept override { return m_String.c_str(); }
+	private:
+		const std::string m_String;
+	};
+
+	// The type bytes of MessagePack. Numbers and lengths following them are big endian.
+	struct msgpack_type {
+		static constexpr std::uint8_t positive_fixint_max = 0x7f;
+		static constexpr std::uint8_t fixmap = 0x80;
+		static constexpr std::uint8_t fixarray = 0x90;
+		static constexpr std::uint8_t fixstr = 0xa0;
+		static constexpr std::uint8_t nil = 0xc0;
+		static constexpr std::uint8_t false_value = 0xc2;
+		static constexpr std::uint8_t true_value = 0xc3;
+		static constexpr std::uint8_t bin8 = 0xc4;
+		static constexpr std::uint8_t bin16 = 0xc5;
+		static constexpr std::uint8_t bin32 = 0xc6;
+		static constexpr std::uint8_t ext8 = 0xc7;
+		static constexpr std::uint8_t ext16 = 0xc8;
+		static constexpr std::uint8_t ext32 = 0xc9;
+		static constexpr std::uint8_t float32 = 0xca;
+		static constexpr std::uint8_t float64 = 0xcb;
+		static constexpr std::uint8_t uint8 = 0xcc;
+		static constexpr std::uint8_t uint16 = 0xcd;
+		static constexpr std::uint8_t uint32 = 0xce;
+		static constexpr std::uint8_t uint64 = 0xcf;
+		static constexpr std::uint8_t int8 = 0xd0;
+		static constexpr std::uint8_t int16 = 0xd1;
+		static constexpr std::uint8_t int32 = 0xd2;
+		static constexpr std::uint8_t int64 = 0xd3;
+		static constexpr std::uint8_t fixext1 = 0xd4;
+		static constexpr std::uint8_t fixext16 = 0xd8;
+		static constexpr std::uint8_t str8 = 0xd9;
+		static constexpr std::uint8_t str16 = 0xda;
+		static constexpr std::uint8_t str32 = 0xdb;
+		static constexpr std::uint8_t array16 = 0xdc;
+		static constexpr std::uint8_t array32 = 0xdd;
+		static constexpr std::uint8_t map16 = 0xde;
+		static constexpr std::uint8_t map32 = 0xdf;
+		static constexpr std::uint8_t negative_fixint = 0xe0;
+
+		// Vectors and arrays of single byte numbers are stored as bin instead of as arrays.
+		template <typename T>
+		static constexpr bool is_byte = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) == 1;
+
+		template <typename T>
+		static void write_big_endian(T value, scts::out_stream& stream) {
+			scts::value_as_binary(to_big_endian(value)).write(stream);
+		}
+
+		template <typename T>
+		static T read_big_endian(scts::in_stream& stream) {
+			return to_big_endian(scts::value_as_binary<T>(stream).value());
+		}
+	};
+}
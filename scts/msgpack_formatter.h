@@ -0,0 +1,10 @@
+#pragma once
+
+#include "msgpack_writer.h"
+#include "msgpack_reader.h"
+
+namespace scts {
+	struct msgpack_formatter : msgpack_writer, msgpack_reader {
+		static constexpr bool requires_names = true;
+	};
+}
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "stream.h"
+#include "helpers.h"
+#include "builtin_types.h"
+#include "reader_helpers.h"
+#include "msgpack_encoding.h"
+
+namespace scts {
+	// Reads MessagePack in a single forward pass. Map keys are handed to the object descriptor as they are encountered,
+	// unknown keys are skipped, and members that are missing from the input are left untouched.
+	// Numbers may use any encoding of their kind that fits the member, so input from other encoders is read as well.
+	struct msgpack_reader {
+		static constexpr bool requires_names = true;
+		static constexpr bool dispatches_by_name = true;
+
+		static void prepare_read(scts::in_stream&) { }
+
+		// Reads a map, calling read_named_member(name) for each key with the stream positioned at the value.
+		// The callback returns false if it did not consume the value.
+		template <typename Callback>
+		static void read_object(scts::in_stream& stream, Callback&& read_named_member) {
+			const auto count = read_map_header(stream);
+			for (std::uint32_t i = 0; i < count; ++i) {
+				const auto name = read_string(stream);
+				if (!read_named_member(name)) skip_value(stream);
+			}
+		}
+
+		template <typename T>
+		static void read_member(T& member, scts::in_stream& stream) {
+			read_value(member, stream);
+		}
+	private:
+		template <typename T>
+		static typename std::enable_if<is_builtin_type<T>::value, void>::type read_value(T& value, scts::in_stream& stream) {
+			builtin_type_reader<T>::read(value, stream);
+		}
+
+		template <typename T>
+		static typename std::enable_if<!is_builtin_type<T>::value, void>::type read_value(T& value, scts::in_stream& stream) {
+			msgpack_reader reader;
+			scts::register_type<T>::descriptor.load(reader, value, stream);
+		}
+
+		static std::uint8_t read_type(scts::in_stream& stream) {
+			return static_cast<std::uint8_t>(stream.get());
+		}
+
+		static std::uint8_t peek_type(const scts::in_stream& stream) {
+			return static_cast<std::uint8_t>(stream.peek());
+		}
+
+		[[noreturn]] static void fail(const scts::in_stream& stream) {
+			throw invalid_msgpack(stream.position() - 1);
+		}
+
+		// Reads the size following a type with 8, 16 or 32-bit sizes.
+		static std::uint32_t read_size(std::uint8_t type, std::uint8_t type8, scts::in_stream& stream) {
+			switch (type - type8) {
+			case 0: return msgpack_type::read_big_endian<std::uint8_t>(stream);
+			case 1: return msgpack_type::read_big_endian<std::uint16_t>(stream);
+			default: return msgpack_type::read_big_endian<std::uint32_t>(stream);
+			}
+		}
+
+		// Reads the header of a map or an array, returning its size.
+		static std::uint32_t read_header(scts::in_stream& stream, std::uint8_t fix, std::uint8_t type16, std::uint8_t type32) {
+			const auto type = read_type(stream);
+			if ((type & 0xf0) == fix) return type & 0x0f;
+			if (type == type16) return msgpack_type::read_big_endian<std::uint16_t>(stream);
+			if (type == type32) return msgpack_type::read_big_endian<std::uint32_t>(stream);
+			fail(stream);
+		}
+
+		static std::uint32_t read_map_header(scts::in_stream& stream) {
+			return read_header(stream, msgpack_type::fixmap, msgpack_type::map16, msgpack_type::map32);
+		}
+
+		static std::uint32_t read_array_header(scts::in_stream& stream) {
+			return read_header(stream, msgpack_type::fixarray, msgpack_type::array16, msgpack_type::array32);
+		}
+
+		static std::string_view read_string(scts::in_stream& stream) {
+			const auto type = read_type(stream);
+			std::uint32_t size;
+			if ((type & 0xe0) == msgpack_type::fixstr) size = type & 0x1f;
+			else if (type >= msgpack_type::str8 && type <= msgpack_type::str32) size = read_size(type, msgpack_type::str8, stream);
+			else fail(stream);
+			return stream.read(size);
+		}
+
+		static std::string_view read_bin(scts::in_stream& stream) {
+			const auto type = read_type(stream);
+			if (type < msgpack_type::bin8 || type > msgpack_type::bin32) fail(stream);
+			return stream.read(read_size(type, msgpack_type::bin8, stream));
+		}
+
+		// Consumes a nil if there is one.
+		static bool read_nil(scts::in_stream& stream) {
+			if (peek_type(stream) != msgpack_type::nil) return false;
+			stream.advance(1);
+			return true;
+		}
+
+		template <typename T>
+		static T read_number(scts::in_stream& stream) {
+			const auto type = read_type(stream);
+			if constexpr (std::is_same_v<T, bool>) {
+				if (type == msgpack_type::true_value) return true;
+				if (type == msgpack_type::false_value) return false;
+				fail(stream);
+			}
+			else {
+				if constexpr (std::is_floating_point_v<T>) {
+					if (type == msgpack_type::float32) return static_cast<T>(msgpack_type::read_big_endian<float>(stream));
+					if (type == msgpack_type::float64) return static_cast<T>(msgpack_type::read_big_endian<double>(stream));
+				}
+				const auto position = stream.position() - 1;
+				if (type <= msgpack_type::positive_fixint_max) return reader_helpers::to_integer<T, invalid_msgpack>(std::uint64_t(type), position);
+				if (type >= msgpack_type::negative_fixint) return reader_helpers::to_integer<T, invalid_msgpack>(std::int64_t(static_cast<std::int8_t>(type)), position);
+				switch (type) {
+				case msgpack_type::uint8: return reader_helpers::to_integer<T, invalid_msgpack>(std::uint64_t(msgpack_type::read_big_endian<std::uint8_t>(stream)), position);
+				case msgpack_type::uint16: return reader_helpers::to_integer<T, invalid_msgpack>(std::uint64_t(msgpack_type::read_big_endian<std::uint16_t>(stream)), position);
+				case msgpack_type::uint32: return reader_helpers::to_integer<T, invalid_msgpack>(std::uint64_t(msgpack_type::read_big_endian<std::uint32_t>(stream)), position);
+				case msgpack_type::uint64: return reader_helpers::to_integer<T, invalid_msgpack>(msgpack_type::read_big_endian<std::uint64_t>(stream), position);
+				case msgpack_type::int8: return reader_helpers::to_integer<T, invalid_msgpack>(std::int64_t(msgpack_type::read_big_endian<std::int8_t>(stream)), position);
+				case msgpack_type::int16: return reader_helpers::to_integer<T, invalid_msgpack>(std::int64_t(msgpack_type::read_big_endian<std::int16_t>(stream)), position);
+				case msgpack_type::int32: return reader_helpers::to_integer<T, invalid_msgpack>(std::int64_t(msgpack_type::read_big_endian<std::int32_t>(stream)), position);
+				case msgpack_type::int64: return reader_helpers::to_integer<T, invalid_msgpack>(msgpack_type::read_big_endian<std::int64_t>(stream), position);
+				default: fail(stream);
+				}
+			}
+		}
+
+		static void skip_values(std::uint64_t count, scts::in_stream& stream) {
+			for (std::uint64_t i = 0; i < count; ++i) skip_value(stream);
+		}
+
+		static void skip_value(scts::in_stream& stream) {
+			const auto type = read_type(stream);
+			if (type <= msgpack_type::positive_fixint_max || type >= msgpack_type::negative_fixint) return;
+			if ((type & 0xf0) == msgpack_type::fixmap) return skip_values(2 * std::uint64_t(type & 0x0f), stream);
+			if ((type & 0xf0) == msgpack_type::fixarray) return skip_values(type & 0x0f, stream);
+			if ((type & 0xe0) == msgpack_type::fixstr) return stream.advance(type & 0x1f);
+			switch (type) {
+			case msgpack_type::nil:
+			case msgpack_type::false_value:
+			case msgpack_type::true_value: return;
+			case msgpack_type::bin8:
+			case msgpack_type::bin16:
+			case msgpack_type::bin32: return stream.advance(read_size(type, msgpack_type::bin8, stream));
+			case msgpack_type::str8:
+			case msgpack_type::str16:
+			case msgpack_type::str32: return stream.advance(read_size(type, msgpack_type::str8, stream));
+			case msgpack_type::ext8:
+			case msgpack_type::ext16:
+			case msgpack_type::ext32: return stream.advance(std::size_t(read_size(type, msgpack_type::ext8, stream)) + 1);
+			case msgpack_type::uint8:
+			case msgpack_type::int8: return stream.advance(1);
+			case msgpack_type::uint16:
+			case msgpack_type::int16: return stream.advance(2);
+			case msgpack_type::float32:
+			case msgpack_type::uint32:
+			case msgpack_type::int32: return stream.advance(4);
+			case msgpack_type::float64:
+			case msgpack_type::uint64:
+			case msgpack_type::int64: return stream.advance(8);
+			case msgpack_type::array16: return skip_values(msgpack_type::read_big_endian<std::uint16_t>(stream), stream);
+			case msgpack_type::array32: return skip_values(msgpack_type::read_big_endian<std::uint32_t>(stream), stream);
+			case msgpack_type::map16: return skip_values(2 * std::uint64_t(msgpack_type::read_big_endian<std::uint16_t>(stream)), stream);
+			case msgpack_type::map32: return skip_values(2 * std::uint64_t(msgpack_type::read_big_endian<std::uint32_t>(stream)), stream);
+			default:
+				// The fixext types hold 1, 2, 4, 8 or 16 bytes after their type byte.
+				if (type >= msgpack_type::fixext1 && type <= msgpack_type::fixext16) return stream.advance((std::size_t(1) << (type - msgpack_type::fixext1)) + 1);
+				fail(stream);
+			}
+		}
+
+		template <typename T>
+		struct builtin_list_reader {
+			// Reads into values, which the function resizes to the count it is given.
+			template <typename Values, typename Resize>
+			static void read(Values& values, Resize&& resize, scts::in_stream& stream) {
+				if constexpr (msgpack_type::is_byte<T>) {
+					const auto bytes = read_bin(stream);
+					resize(bytes.size());
+					if (!bytes.empty()) std::memcpy(&*std::begin(values), bytes.data(), bytes.size());
+				}
+				else {
+					const auto count = read_array_header(stream);
+					resize(count);
+					for (auto& value : values) read_value(value, stream);
+				}
+			}
+		};
+
+		// Strings and arithmetic types.
+		template <typename T, typename = void>
+		struct builtin_type_reader {
+			static void read(T& value, scts::in_stream& stream) {
+				if constexpr (std::is_same_v<T, std::string>) value = std::string(read_string(stream));
+				else value = read_number<T>(stream);
+			}
+		};
+
+		// Enums.
+		template <typename Enum>
+		struct builtin_type_reader<Enum, std::enable_if_t<std::is_enum_v<Enum>>> {
+			static void read(Enum& value, scts::in_stream& stream) {
+				value = static_cast<Enum>(read_number<std::underlying_type_t<Enum>>(stream));
+			}
+		};
+
+		// C-style pointers and arrays.
+		template <typename T>
+		struct builtin_type_reader<T*> {
+			static void read(T*& value, scts::in_stream& stream) {
+				if (read_nil(stream)) {
+					value = nullptr;
+				}
+				else {
+					read_value(scts::allocate_pointee(value), stream);
+				}
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_reader<T[C]> {
+			static void read(T(&values)[C], scts::in_stream& stream) {
+				reader_helpers::read_fixed_list<builtin_list_reader<T>, invalid_msgpack, C>(values, stream);
+			}
+		};
+
+		// Standard library containers and classes.
+		template <typename T>
+		struct builtin_type_reader<std::vector<T>> {
+			static void read(std::vector<T>& values, scts::in_stream& stream) {
+				reader_helpers::read_vector<builtin_list_reader<T>>(values, stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_reader<std::array<T, C>> {
+			static void read(std::array<T, C>& values, scts::in_stream& stream) {
+				reader_helpers::read_fixed_list<builtin_list_reader<T>, invalid_msgpack, C>(values.data(), stream);
+			}
+		};
+
+		template <typename V>
+		struct builtin_type_reader<std::map<std::string, V>> {
+			static void read(std::map<std::string, V>& values, scts::in_stream& stream) {
+				const auto count = read_map_header(stream);
+				values.clear();
+				for (std::uint32_t i = 0; i < count; ++i) {
+					std::string key(read_string(stream));
+					V value{};
+					read_value(value, stream);
+					values.insert(std::make_pair(std::move(key), std::move(value)));
+				}
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_reader<std::optional<T>> {
+			static void read(std::optional<T>& value, scts::in_stream& stream) {
+				if (read_nil(stream)) {
+					value = std::nullopt;
+				}
+				else {
+					value = T{};
+					read_value(value.value(), stream);
+				}
+			}
+		};
+
+		// Standard library smart pointers.
+		template <typename T>
+		struct builtin_type_reader<std::unique_ptr<T>> {
+			static void read(std::unique_ptr<T>& value, scts::in_stream& stream) {
+				if (read_nil(stream)) {
+					value = nullptr;
+				}
+				else {
+					value = std::make_unique<T>();
+					read_value(*value.get(), stream);
+				}
+			}
+		};
+	};
+}
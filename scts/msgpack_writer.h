@@ -0,0 +1,269 @@
+#pragma once
+
+#include <string>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "stream.h"
+#include "builtin_types.h"
+#include "msgpack_encoding.h"
+
+namespace scts {
+	// Writes registered types as MessagePack maps keyed by the names of their descriptors, using the smallest encoding
+	// of each number and length. Vectors and arrays of bytes are written as bin, null pointers and empty optionals as nil.
+	struct msgpack_writer {
+		static constexpr bool requires_names = true;
+
+		// The root object is a map32, whose size is only filled in once all of its members are written.
+		void prepare_write(scts::out_stream& stream) {
+			m_root = stream.size();
+			m_root_members = 0;
+			m_depth = 0;
+			stream.push_back(static_cast<char>(msgpack_type::map32));
+			msgpack_type::write_big_endian(std::uint32_t(0), stream);
+		}
+
+		void post_write(scts::out_stream& stream) {
+			const auto count = to_big_endian(m_root_members);
+			std::memcpy(stream.data() + m_root + 1, &count, sizeof(count));
+		}
+
+		template <typename T>
+		scts::out_stream& write_member(const T& value, scts::out_stream& stream, const std::string_view& name, bool) {
+			static_assert(scts::is_serializable_v<T>);
+
+			if (m_depth == 0) m_root_members++;
+			write_string(name, stream);
+			write_value(value, stream);
+			return stream;
+		}
+
+		// The members of parents are part of the same map.
+		static void write_inherited_object_separator(scts::out_stream&) { }
+	private:
+		template <typename T>
+		typename std::enable_if<is_builtin_type<T>::value, void>::type write_value(const T& value, scts::out_stream& stream) {
+			builtin_type_writer<T>::write(*this, value, stream);
+		}
+
+		template <typename T>
+		typename std::enable_if<!is_builtin_type<T>::value, void>::type write_value(const T& value, scts::out_stream& stream) {
+			const auto& descriptor = scts::register_type<T>::descriptor;
+			write_header(std::decay_t<decltype(descriptor)>::member_count, msgpack_type::fixmap, msgpack_type::map16, msgpack_type::map32, stream);
+			m_depth++;
+			descriptor.save(*this, value, stream);
+			m_depth--;
+		}
+
+		static void write_type(std::uint8_t type, scts::out_stream& stream) {
+			stream.push_back(static_cast<char>(type));
+		}
+
+		// Writes the type and size of a string, bin, map or array that is too long for the shorter variants.
+		static void write_sized(std::size_t size, std::uint8_t type16, std::uint8_t type32, scts::out_stream& stream) {
+			if (size <= std::numeric_limits<std::uint16_t>::max()) {
+				write_type(type16, stream);
+				msgpack_type::write_big_endian(static_cast<std::uint16_t>(size), stream);
+			}
+			else {
+				write_type(type32, stream);
+				msgpack_type::write_big_endian(static_cast<std::uint32_t>(size), stream);
+			}
+		}
+
+		// Writes the header of a map or an array, as its fix variant if the size allows.
+		static void write_header(std::size_t size, std::uint8_t fix, std::uint8_t type16, std::uint8_t type32, scts::out_stream& stream) {
+			if (size <= 15) write_type(static_cast<std::uint8_t>(fix | size), stream);
+			else write_sized(size, type16, type32, stream);
+		}
+
+		static void write_string(std::string_view value, scts::out_stream& stream) {
+			if (value.size() <= 31) {
+				write_type(static_cast<std::uint8_t>(msgpack_type::fixstr | value.size()), stream);
+			}
+			else if (value.size() <= std::numeric_limits<std::uint8_t>::max()) {
+				write_type(msgpack_type::str8, stream);
+				msgpack_type::write_big_endian(static_cast<std::uint8_t>(value.size()), stream);
+			}
+			else {
+				write_sized(value.size(), msgpack_type::str16, msgpack_type::str32, stream);
+			}
+			stream.append(value);
+		}
+
+		static void write_bin(const char* bytes, std::size_t size, scts::out_stream& stream) {
+			if (size <= std::numeric_limits<std::uint8_t>::max()) {
+				write_type(msgpack_type::bin8, stream);
+				msgpack_type::write_big_endian(static_cast<std::uint8_t>(size), stream);
+			}
+			else {
+				write_sized(size, msgpack_type::bin16, msgpack_type::bin32, stream);
+			}
+			stream.append(bytes, size);
+		}
+
+		static void write_integer(std::int64_t value, scts::out_stream& stream) {
+			if (value >= 0) {
+				write_integer(static_cast<std::uint64_t>(value), stream);
+			}
+			else if (value >= -32) {
+				write_type(static_cast<std::uint8_t>(value), stream);
+			}
+			else if (value >= std::numeric_limits<std::int8_t>::min()) {
+				write_type(msgpack_type::int8, stream);
+				msgpack_type::write_big_endian(static_cast<std::int8_t>(value), stream);
+			}
+			else if (value >= std::numeric_limits<std::int16_t>::min()) {
+				write_type(msgpack_type::int16, stream);
+				msgpack_type::write_big_endian(static_cast<std::int16_t>(value), stream);
+			}
+			else if (value >= std::numeric_limits<std::int32_t>::min()) {
+				write_type(msgpack_type::int32, stream);
+				msgpack_type::write_big_endian(static_cast<std::int32_t>(value), stream);
+			}
+			else {
+				write_type(msgpack_type::int64, stream);
+				msgpack_type::write_big_endian(value, stream);
+			}
+		}
+
+		static void write_integer(std::uint64_t value, scts::out_stream& stream) {
+			if (value <= msgpack_type::positive_fixint_max) {
+				write_type(static_cast<std::uint8_t>(value), stream);
+			}
+			else if (value <= std::numeric_limits<std::uint8_t>::max()) {
+				write_type(msgpack_type::uint8, stream);
+				msgpack_type::write_big_endian(static_cast<std::uint8_t>(value), stream);
+			}
+			else if (value <= std::numeric_limits<std::uint16_t>::max()) {
+				write_type(msgpack_type::uint16, stream);
+				msgpack_type::write_big_endian(static_cast<std::uint16_t>(value), stream);
+			}
+			else if (value <= std::numeric_limits<std::uint32_t>::max()) {
+				write_type(msgpack_type::uint32, stream);
+				msgpack_type::write_big_endian(static_cast<std::uint32_t>(value), stream);
+			}
+			else {
+				write_type(msgpack_type::uint64, stream);
+				msgpack_type::write_big_endian(value, stream);
+			}
+		}
+
+		template <typename T>
+		static void write_number(T value, scts::out_stream& stream) {
+			if constexpr (std::is_same_v<T, bool>) {
+				write_type(value ? msgpack_type::true_value : msgpack_type::false_value, stream);
+			}
+			else if constexpr (std::is_same_v<T, float>) {
+				write_type(msgpack_type::float32, stream);
+				msgpack_type::write_big_endian(value, stream);
+			}
+			else if constexpr (std::is_floating_point_v<T>) {
+				write_type(msgpack_type::float64, stream);
+				msgpack_type::write_big_endian(static_cast<double>(value), stream);
+			}
+			else if constexpr (std::is_signed_v<T>) {
+				write_integer(static_cast<std::int64_t>(value), stream);
+			}
+			else {
+				write_integer(static_cast<std::uint64_t>(value), stream);
+			}
+		}
+
+		template <typename T>
+		struct builtin_list_writer {
+			template <typename Iterator>
+			static void write(msgpack_writer& writer, Iterator begin, std::size_t size, scts::out_stream& stream) {
+				if constexpr (msgpack_type::is_byte<T>) {
+					write_bin(size == 0 ? nullptr : reinterpret_cast<const char*>(&*begin), size, stream);
+				}
+				else {
+					write_header(size, msgpack_type::fixarray, msgpack_type::array16, msgpack_type::array32, stream);
+					for (std::size_t i = 0; i < size; ++i, ++begin) writer.write_value(*begin, stream);
+				}
+			}
+		};
+
+		// Strings and arithmetic types.
+		template <typename T, typename = void>
+		struct builtin_type_writer {
+			static void write(msgpack_writer&, const T& value, scts::out_stream& stream) {
+				if constexpr (std::is_same_v<T, std::string>) write_string(value, stream);
+				else write_number(value, stream);
+			}
+		};
+
+		// Enums.
+		template <typename Enum>
+		struct builtin_type_writer<Enum, std::enable_if_t<std::is_enum_v<Enum>>> {
+			static void write(msgpack_writer&, const Enum& value, scts::out_stream& stream) {
+				write_number(static_cast<std::underlying_type_t<Enum>>(value), stream);
+			}
+		};
+
+		// C-style pointers and arrays.
+		template <typename T>
+		struct builtin_type_writer<T*> {
+			static void write(msgpack_writer& writer, const T* value, scts::out_stream& stream) {
+				if (value == nullptr) write_type(msgpack_type::nil, stream);
+				else writer.write_value(*value, stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_writer<T[C]> {
+			static void write(msgpack_writer& writer, const T(&values)[C], scts::out_stream& stream) {
+				builtin_list_writer<T>::write(writer, std::begin(values), C, stream);
+			}
+		};
+
+		// Standard library containers and classes.
+		template <typename T>
+		struct builtin_type_writer<std::vector<T>> {
+			static void write(msgpack_writer& writer, const std::vector<T>& values, scts::out_stream& stream) {
+				builtin_list_writer<T>::write(writer, values.begin(), values.size(), stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct builtin_type_writer<std::array<T, C>> {
+			static void write(msgpack_writer& writer, const std::array<T, C>& values, scts::out_stream& stream) {
+				builtin_list_writer<T>::write(writer, values.begin(), C, stream);
+			}
+		};
+
+		template <typename V>
+		struct builtin_type_writer<std::map<std::string, V>> {
+			static void write(msgpack_writer& writer, const std::map<std::string, V>& values, scts::out_stream& stream) {
+				write_header(values.size(), msgpack_type::fixmap, msgpack_type::map16, msgpack_type::map32, stream);
+				for (const auto& [key, value] : values) {
+					write_string(key, stream);
+					writer.write_value(value, stream);
+				}
+			}
+		};
+
+		template <typename T>
+		struct builtin_type_writer<std::optional<T>> {
+			static void write(msgpack_writer& writer, const std::optional<T>& value, scts::out_stream& stream) {
+				if (value.has_value()) writer.write_value(value.value(), stream);
+				else write_type(msgpack_type::nil, stream);
+			}
+		};
+
+		// Standard library smart pointers.
+		template <typename T>
+		struct builtin_type_writer<std::unique_ptr<T>> {
+			static void write(msgpack_writer& writer, const std::unique_ptr<T>& value, scts::out_stream& stream) {
+				builtin_type_writer<T*>::write(writer, value.get(), stream);
+			}
+		};
+
+		std::size_t m_root = 0;
+		std::uint32_t m_root_members = 0;
+		std::size_t m_depth = 0;
+	};
+}
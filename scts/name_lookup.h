@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+
+namespace scts {
+	// 64-bit FNV-1a, followed by the MurmurHash3 finalizer so that the upper bits are well mixed for short names too.
+	constexpr std::uint64_t hash_name(std::string_view name) noexcept {
+		std::uint64_t hash = 14695981039346656037ull;
+		for (const auto character : name) {
+			hash ^= static_cast<unsigned char>(character);
+			hash *= 1099511628211ull;
+		}
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	constexpr std::size_t round_up_to_power_of_two(std::size_t value) noexcept {
+		std::size_t power = 1;
+		while (power < value) power *= 2;
+		return power;
+	}
+
+	constexpr std::uint32_t log2_of_power_of_two(std::size_t value) noexcept {
+		std::uint32_t log = 0;
+		while (value > 1) {
+			value /= 2;
+			log++;
+		}
+		return log;
+	}
+
+	// A perfect hash table from member names to member indices, built at compile time from the names of an object descriptor.
+	// Uses hash and displace: the names are first split into buckets, and each bucket then gets its own seed
+	// that places all of its names into free slots. A lookup is a single hash of the name, two table reads and one comparison.
+	template <std::size_t N>
+	struct name_lookup {
+		static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+		using name_container = std::array<std::string_view, N>;
+
+		constexpr name_lookup() noexcept = default;
+
+		constexpr name_lookup(const name_container& names) : m_names(names) {
+			static_assert(N < std::numeric_limits<std::uint16_t>::max(), "too many names for a name_lookup");
+
+			// Groups the name indices by bucket.
+			std::array<std::uint64_t, N> hashes{};
+			std::array<std::size_t, bucket_count + 1> bucket_starts{};
+			for (std::size_t i = 0; i < N; ++i) {
+				hashes[i] = hash_name(names[i]);
+				bucket_starts[bucket_of(hashes[i]) + 1]++;
+			}
+			std::size_t largest_bucket = 0;
+			for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+				if (bucket_starts[bucket + 1] > largest_bucket) largest_bucket = bucket_starts[bucket + 1];
+				bucket_starts[bucket + 1] += bucket_starts[bucket];
+			}
+			std::array<std::size_t, N> grouped{};
+			auto bucket_ends = bucket_starts;
+			for (std::size_t i = 0; i < N; ++i) {
+				grouped[bucket_ends[bucket_of(hashes[i])]++] = i;
+			}
+
+			// Placing the largest buckets first keeps the amount of seeds tried low.
+			for (std::size_t size = largest_bucket; size > 0; --size) {
+				for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+					if (bucket_starts[bucket + 1] - bucket_starts[bucket] == size) {
+						place_bucket(bucket, grouped, bucket_starts[bucket], bucket_starts[bucket + 1], hashes);
+					}
+				}
+			}
+		}
+
+		// Returns the index of the name, or npos if there is no such name.
+		constexpr std::size_t find(std::string_view name) const noexcept {
+			const auto hash = hash_name(name);
+			const std::size_t index = m_slots[slot_of(hash, m_seeds[bucket_of(hash)])];
+			if (index == 0 || m_names[index - 1] != name) return npos;
+			return index - 1;
+		}
+	private:
+		static constexpr std::size_t bucket_count = round_up_to_power_of_two(N / 2 + 1);
+		static constexpr std::size_t slot_count = round_up_to_power_of_two(N * 2 + 2);
+		static constexpr std::uint32_t slot_shift = 32 - log2_of_power_of_two(slot_count);
+		static constexpr std::uint32_t max_seed = 1u << 16;
+
+		static constexpr std::size_t bucket_of(std::uint64_t hash) noexcept {
+			return static_cast<std::size_t>(hash >> 32) & (bucket_count - 1);
+		}
+
+		static constexpr std::size_t slot_of(std::uint64_t hash, std::uint32_t seed) noexcept {
+			const std::uint32_t mixed = (static_cast<std::uint32_t>(hash) ^ seed) * 0x9E3779B1u;
+			return static_cast<std::size_t>(mixed >> slot_shift);
+		}
+
+		constexpr void place_bucket(std::size_t bucket, const std::array<std::size_t, N>& grouped, std::size_t begin, std::size_t end,
+			const std::array<std::uint64_t, N>& hashes) {
+			for (std::uint32_t seed = 0; seed < max_seed; ++seed) {
+				if (fits_bucket(grouped, begin, end, hashes, seed)) {
+					for (std::size_t i = begin; i < end; ++i) {
+						m_slots[slot_of(hashes[grouped[i]], seed)] = static_cast<std::uint16_t>(grouped[i] + 1);
+					}
+					m_seeds[bucket] = seed;
+					return;
+				}
+			}
+			// Only reachable with duplicate names, and fails the compilation of a constexpr descriptor.
+			throw std::logic_error("object_descriptor names need to be unique");
+		}
+
+		constexpr bool fits_bucket(const std::array<std::size_t, N>& grouped, std::size_t begin, std::size_t end,
+			const std::array<std::uint64_t, N>& hashes, std::uint32_t seed) const {
+			for (std::size_t i = begin; i < end; ++i) {
+				const auto slot = slot_of(hashes[grouped[i]], seed);
+				if (m_slots[slot] != 0) return false;
+				for (std::size_t j = begin; j < i; ++j) {
+					if (slot_of(hashes[grouped[j]], seed) == slot) return false;
+				}
+			}
+			return true;
+		}
+
+		name_container m_names{};
+		std::array<std::uint32_t, bucket_count> m_seeds{};
+		// Indices are stored offset by one, so that zero marks an empty slot.
+		std::array<std::uint16_t, slot_count> m_slots{};
+	};
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <type_traits>
+
+namespace scts {
+	// Writing numbers as text directly into a character buffer, like std::to_chars.
+	// Integers go through a two digits at a time lookup table, floating point numbers are written
+	// with the shortest representation that reads back to the same value.
+
+	// The amount of characters that is always enough to hold a formatted T.
+	template <typename T>
+	inline constexpr std::size_t max_formatted_size = std::is_floating_point_v<T>
+		? 4 + std::numeric_limits<T>::max_digits10 + 8  // Sign, decimal point, exponent and its sign.
+		: 2 + std::numeric_limits<T>::digits10;  // Sign, and the partial leading digit.
+
+	inline constexpr char digit_pairs[] =
+		"00010203040506070809101112131415161718192021222324"
+		"25262728293031323334353637383940414243444546474849"
+		"50515253545556575859606162636465666768697071727374"
+		"75767778798081828384858687888990919293949596979899";
+
+	template <typename U>
+	inline std::uint32_t count_digits(U value) noexcept {
+		std::uint32_t digits = 1;
+		for (;;) {
+			if (value < 10) return digits;
+			if (value < 100) return digits + 1;
+			if (value < 1000) return digits + 2;
+			if (value < 10000) return digits + 3;
+			value /= 10000u;
+			digits += 4;
+		}
+	}
+
+	// Writes the digits of value, backwards from end.
+	template <typename U>
+	inline void format_digits(char* end, U value) noexcept {
+		while (value >= 100) {
+			const auto pair = static_cast<std::size_t>(value % 100) * 2;
+			value /= 100;
+			end -= 2;
+			std::memcpy(end, digit_pairs + pair, 2);
+		}
+		if (value >= 10) {
+			std::memcpy(end - 2, digit_pairs + static_cast<std::size_t>(value) * 2, 2);
+		}
+		else {
+			*(end - 1) = static_cast<char>('0' + value);
+		}
+	}
+
+	// Returns one past the last written character. Requires max_formatted_size<T> characters of space.
+	template <typename T>
+	inline char* format_integer(char* out, T value) noexcept {
+		static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>);
+		using unsigned_type = std::make_unsigned_t<T>;
+
+		auto magnitude = static_cast<unsigned_type>(value);
+		if constexpr (std::is_signed_v<T>) {
+			if (value < 0) {
+				*out++ = '-';
+				magnitude = static_cast<unsigned_type>(unsigned_type(0) - magnitude);
+			}
+		}
+
+		// 32-bit divisions are cheaper, so those are used whenever the value fits.
+		if constexpr (sizeof(T) > sizeof(std::uint32_t)) {
+			if (magnitude > std::numeric_limits<std::uint32_t>::max()) {
+				const auto end = out + count_digits(magnitude);
+				format_digits(end, magnitude);
+				return end;
+			}
+		}
+		const auto narrow = static_cast<std::uint32_t>(magnitude);
+		const auto end = out + count_digits(narrow);
+		format_digits(end, narrow);
+		return end;
+	}
+
+	// Returns one past the last written character. Requires max_formatted_size<T> characters of space.
+	template <typename T>
+	inline char* format_floating_point(char* out, T value) noexcept {
+		static_assert(std::is_floating_point_v<T>);
+		return std::to_chars(out, out + max_formatted_size<T>, value).ptr;
+	}
+
+	template <typename T>
+	inline char* format_number(char* out, T value) noexcept {
+		if constexpr (std::is_floating_point_v<T>) return format_floating_point(out, value);
+		else return format_integer(out, value);
+	}
+}
@@ -1,72 +1,80 @@
 #pragma once
 
+#include <array>
+#include <string_view>
 #include <type_traits>
 
 #include "io.h"
 #include "helpers.h"
 #include "formatters.h"
+#include "fingerprint.h"
+#include "field_lookup.h"
+#include "name_lookup.h"
 #include "register_type.h"
+#include "value_as_binary.h"
 
 namespace scts {
 	template <typename... Parents>
 	struct inherits_from {
+		static constexpr std::size_t member_count = (std::decay_t<decltype(scts::register_type<Parents>::descriptor)>::member_count + ... + 0);
+
 		template <typename Formatter, typename O>
-		static void write(Formatter& formatter, const O& object, scts::out_stream& stream) {
-			write_detail::template write<Formatter, O, Parents...>(formatter, object, stream);
+		static void write([[maybe_unused]] Formatter& formatter, [[maybe_unused]] const O& object, [[maybe_unused]] scts::out_stream& stream) {
+			((scts::register_type<Parents>::descriptor.save(formatter, object, stream), formatter.write_inherited_object_separator(stream)), ...);
 		}
 
 		template <typename Formatter, typename O>
-		static void read(Formatter& formatter, O& object, scts::in_stream& stream) {
-			read_detail::template read<Formatter, O, Parents...>(formatter, object, stream);
+		static void read([[maybe_unused]] Formatter& formatter, [[maybe_unused]] O& object, [[maybe_unused]] scts::in_stream& stream) {
+			(scts::register_type<Parents>::descriptor.load(formatter, object, stream), ...);
 		}
-	private:
-		struct write_detail {
-			template <typename Formatter, typename O>
-			static void write(Formatter&, const O&, scts::out_stream&) { }
 
-			template <typename Formatter, typename O, typename Parent>
-			static void write(Formatter& formatter, const O& object, scts::out_stream& stream) {
-				write_parent<Formatter, O, Parent>(formatter, object, stream);
-			}
-
-			template <typename Formatter, typename O, typename Parent, typename Second, typename... Rest>
-			static void write(Formatter& formatter, const O& object, scts::out_stream& stream) {
-				write_parent<Formatter, O, Parent>(formatter, object, stream);
-				write<Formatter, O, Second, Rest...>(formatter, object, stream);
-			}
+		// Reads the parent member with the given name. Returns false if none of the parents has such a member.
+		template <typename Formatter, typename O>
+		static bool read_member(Formatter& formatter, O& object, scts::in_stream& stream, [[maybe_unused]] std::string_view name) {
+			return (scts::register_type<Parents>::descriptor.load_member(formatter, object, stream, name) || ...);
+		}
 
-			template <typename Formatter, typename O, typename Parent>
-			static void write_parent(Formatter& formatter, const O& object, scts::out_stream& stream) {
-				scts::register_type<Parent>::descriptor.save(formatter, object, stream);
-				formatter.write_inherited_object_separator(stream);
-			}
-		};
+		// Reads the parent member with the given field number. Returns false if none of the parents has such a member.
+		template <typename Formatter, typename O>
+		static bool read_field(Formatter& formatter, O& object, scts::in_stream& stream, [[maybe_unused]] std::uint32_t field_number) {
+			return (scts::register_type<Parents>::descriptor.load_field(formatter, object, stream, field_number) || ...);
+		}
 
-		struct read_detail {
-			template <typename Formatter, typename O>
-			static void read(Formatter&, O&, scts::in_stream&) { }
+		// The field numbers of the members of the parents, in order.
+		static constexpr std::array<std::uint32_t, member_count> field_numbers() noexcept {
+			std::array<std::uint32_t, member_count> numbers{};
+			[[maybe_unused]] std::size_t at = 0;
+			((at = field_lookup_detail::append(numbers, at, std::decay_t<decltype(scts::register_type<Parents>::descriptor)>::field_numbers())), ...);
+			return numbers;
+		}
 
-			template <typename Formatter, typename O, typename Parent>
-			static void read(Formatter& formatter, O& object, scts::in_stream& stream) {
-				read_parent<Formatter, O, Parent>(formatter, object, stream);
-			}
+		// Calls f with each member of the parents, in order.
+		template <typename F>
+		static void for_each_member(F& f) {
+			(std::decay_t<decltype(scts::register_type<Parents>::descriptor)>::for_each_member(f), ...);
+		}
 
-			template <typename Formatter, typename O, typename Parent, typename Second, typename... Rest>
-			static void read(Formatter& formatter, O& object, scts::in_stream& stream) {
-				read_parent<Formatter, O, Parent>(formatter, object, stream); 
-				read<Formatter, O, Second, Rest...>(formatter, object, stream);
-			}
+		// Calls f with each member of the parents and its name, in order.
+		template <typename F>
+		static void for_each_named_member(F& f) {
+			(scts::register_type<Parents>::descriptor.for_each_named_member(f), ...);
+		}
 
-			template <typename Formatter, typename O, typename Parent>
-			static void read_parent(Formatter& formatter, O& object, scts::in_stream& stream) {
-				scts::register_type<Parent>::descriptor.load(formatter, object, stream);
-			}
-		};
+		static constexpr std::uint64_t fingerprint() noexcept {
+			auto hash = hash_name("parents");
+			((hash = combine_fingerprint(hash, scts::register_type<Parents>::descriptor.fingerprint())), ...);
+			return hash;
+		}
 	};
 
-	template <auto Ptr>
+	// The field number is optional, and only needed by formatters that identify members by number instead of by name.
+	template <auto Ptr, std::uint32_t FieldNumber = 0>
 	struct member {
 		using value_type = typename scts::deduce_member_ptr_type<decltype(Ptr)>::type;
+		static constexpr auto pointer = Ptr;
+		static constexpr std::uint32_t field_number = FieldNumber;
+
+		static_assert(FieldNumber < (1u << 29), "field numbers need to fit into 29 bits");
 
 		static_assert(scts::is_builtin_type_v<value_type> || scts::is_registered_type_v<value_type>,
 			"member needs to be a basic value or a registered type!");
@@ -80,60 +88,234 @@ namespace scts {
 		static constexpr const value_type& get(const O& object) noexcept { return object.*Ptr; }
 	};
 
+	// A constant object, used to find out where the members of O lie in memory at compile time.
+	template <typename O>
+	inline constexpr O layout_probe{};
+
 	template <typename... Members>
 	struct members { 
 		static constexpr auto member_count = sizeof...(Members);
 		using name_container = std::array<std::string_view, member_count>;
+		using field_lookup = scts::field_lookup<Members::field_number...>;
+
+		// True if the members are listed in the order they are laid out in O, which also means that none is listed twice.
+		template <typename O>
+		static constexpr bool in_layout_order() noexcept {
+			const std::array<const void*, member_count> addresses{ &(layout_probe<O>.*Members::pointer)... };
+			for (std::size_t i = 1; i < member_count; ++i) {
+				if (!(addresses[i - 1] < addresses[i])) return false;
+			}
+			return true;
+		}
+
+		// True if the members are bulk copyable, listed in layout order, and together take up all of O, leaving no room
+		// for padding. Only then are the raw bytes of O the same as writing its members one by one.
+		// The layout can only be inspected for objects that can be constructed at compile time.
+		template <typename O>
+		static constexpr bool fills_bulk_copyable_object() noexcept {
+			if constexpr ((scts::is_bulk_copyable_v<typename Members::value_type> && ...) &&
+				(sizeof(typename Members::value_type) + ... + 0) == sizeof(O) && std::is_trivially_default_constructible_v<O>) {
+				return in_layout_order<O>();
+			}
+			else {
+				return false;
+			}
+		}
+
+		template <typename F>
+		static void for_each_member(F& f) {
+			(f(Members{}), ...);
+		}
+
+		template <typename F>
+		static void for_each_named_member([[maybe_unused]] F& f, [[maybe_unused]] const name_container& names) {
+			if constexpr (member_count > 0) {
+				std::size_t index = 0;
+				(f(Members{}, names[index++]), ...);
+			}
+		}
+
+		static constexpr std::array<std::uint32_t, member_count> field_numbers() noexcept {
+			return { Members::field_number... };
+		}
+
+		static constexpr std::uint64_t fingerprint() noexcept {
+			auto hash = hash_name("members");
+			((hash = combine_fingerprint(hash, scts::type_fingerprint_v<typename Members::value_type>)), ...);
+			return hash;
+		}
 
 		template <typename Formatter, typename O>
-		static scts::out_stream& save(Formatter& formatter, const O& object, scts::out_stream& stream, const name_container& names) {
-			if constexpr (formatter.requires_names) {
-				return writer<O, name_container>::template write<Formatter, Members...>(formatter, object, stream, names, 0);
+		static scts::out_stream& save(Formatter& formatter, const O& object, scts::out_stream& stream, [[maybe_unused]] const name_container& names) {
+			if constexpr (scts::formatter_uses_field_numbers_v<Formatter>) {
+				static_assert(((Members::field_number != 0) && ...), "every member needs a field number for this formatter");
+				(formatter.write_field(Members::get(object), stream, Members::field_number), ...);
+				return stream;
+			}
+			else if constexpr (formatter.requires_names) {
+				return writer<O, name_container>::template write<Formatter, Members...>(formatter, object, stream, names);
 			}
 			else {
-				names;
 				return writer_no_names<O>::template write<Formatter, Members...>(formatter, object, stream);
 			}
 		}
 
 		template <typename Formatter, typename O>
-		static O& load(Formatter& formatter, O& object, scts::in_stream& stream, const name_container& names) {
+		static O& load(Formatter& formatter, O& object, scts::in_stream& stream, [[maybe_unused]] const name_container& names) {
 			if constexpr (formatter.requires_names) {
-				return reader<O, name_container>::template read<Formatter, Members...>(formatter, object, stream, names, 0);
+				return reader<O, name_container>::template read<Formatter, Members...>(formatter, object, stream, names);
 			}
 			else {
-				names;
 				return reader_no_names<O>::template read<Formatter, Members...>(formatter, object, stream);
 			}
 		}
+
+		// Reads the member at the given index through a jump table.
+		template <typename Formatter, typename O>
+		static void load_member(Formatter& formatter, O& object, scts::in_stream& stream, std::size_t index) {
+			if constexpr (member_count > 0) {
+				using member_loader = void(*)(Formatter&, O&, scts::in_stream&);
+				static constexpr member_loader loaders[] = { &load_single_member<Formatter, O, Members>... };
+				loaders[index](formatter, object, stream);
+			}
+		}
+
+		// Reads the member with the given field number. Returns false if there is no such member.
+		template <typename Formatter, typename O>
+		static bool load_field(Formatter& formatter, O& object, scts::in_stream& stream, std::uint32_t field_number) {
+			const auto index = field_lookup::find(field_number);
+			if (index == field_lookup::npos) return false;
+			load_member(formatter, object, stream, index);
+			return true;
+		}
+	private:
+		template <typename Formatter, typename O, typename Member>
+		static void load_single_member(Formatter& formatter, O& object, scts::in_stream& stream) {
+			formatter.read_member(Member::get(object), stream);
+		}
 	};
 
 	template <typename O, typename Members, typename InheritsFrom = inherits_from<>>
 	struct object_descriptor {
+		using members_type = Members;
+		using parents_type = InheritsFrom;
+
+		// The amount of members of the object, including those of its parents.
+		static constexpr std::size_t member_count = InheritsFrom::member_count + Members::member_count;
+
 		// It's possible to construct an object descriptor without any names.
 		// That will restrict the serialization to formatters that only serialize without names, though.
-		constexpr object_descriptor() noexcept : has_names(false) { }
+		constexpr object_descriptor() noexcept : has_names(false), m_names(), m_fingerprint(compute_fingerprint(m_names, false)) { }
 
 		template <typename... Names>
-		constexpr object_descriptor(Names... names) noexcept 
-			: has_names(true), m_names({ names... }) {
+		constexpr object_descriptor(Names... names)
+			: has_names(true), m_names({ names... }), m_lookup(m_names), m_fingerprint(compute_fingerprint(m_names, true)) {
 			static_assert(sizeof...(Names) == Members::member_count, "object_descriptor needs the correct amount of names");
 		}
 
+		// The field numbers of all members, starting with those of the parents.
+		static constexpr std::array<std::uint32_t, member_count> field_numbers() noexcept {
+			std::array<std::uint32_t, member_count> numbers{};
+			const auto at = field_lookup_detail::append(numbers, 0, InheritsFrom::field_numbers());
+			field_lookup_detail::append(numbers, at, Members::field_numbers());
+			return numbers;
+		}
+
+		// Trivially copyable objects without parents, whose members cover the whole object in descriptor order,
+		// can be stored as their raw bytes.
+		static constexpr bool is_bulk_copyable = std::is_trivially_copyable_v<O> &&
+			std::is_same_v<InheritsFrom, inherits_from<>> && Members::template fills_bulk_copyable_object<O>();
+
 		template <typename Formatter>
 		scts::out_stream& save(Formatter& formatter, const O& object, scts::out_stream& stream) const {
-			InheritsFrom::write(formatter, object, stream);
-			return Members::save(formatter, object, stream, m_names);
+			if constexpr (is_bulk_copyable && scts::formatter_copies_bulk_objects_v<Formatter>) {
+				formatter.write_object_bytes(object, stream);
+				return stream;
+			}
+			else {
+				InheritsFrom::write(formatter, object, stream);
+				return Members::save(formatter, object, stream, m_names);
+			}
 		}
 
 		template <typename Formatter>
 		O& load(Formatter& formatter, O& object, scts::in_stream& stream) const {
-			InheritsFrom::read(formatter, object, stream);
-			return Members::load(formatter, object, stream, m_names);
+			if constexpr (is_bulk_copyable && scts::formatter_copies_bulk_objects_v<Formatter>) {
+				formatter.read_object_bytes(object, stream);
+				return object;
+			}
+			else if constexpr (scts::formatter_uses_field_numbers_v<Formatter>) {
+				formatter.read_fields(object, stream, [&](std::uint32_t field_number) {
+					return load_field(formatter, object, stream, field_number);
+				});
+				return object;
+			}
+			else if constexpr (scts::formatter_dispatches_by_name_v<Formatter>) {
+				formatter.read_object(stream, [&](std::string_view name) {
+					return load_member(formatter, object, stream, name);
+				});
+				return object;
+			}
+			else {
+				InheritsFrom::read(formatter, object, stream);
+				return Members::load(formatter, object, stream, m_names);
+			}
+		}
+
+		// Reads the member with the given name, including the members of inherited objects.
+		// Returns false if the object has no such member.
+		template <typename Formatter>
+		bool load_member(Formatter& formatter, O& object, scts::in_stream& stream, std::string_view name) const {
+			const auto index = m_lookup.find(name);
+			if (index != name_lookup::npos) {
+				Members::load_member(formatter, object, stream, index);
+				return true;
+			}
+			return InheritsFrom::read_member(formatter, object, stream, name);
+		}
+
+		// Reads the member with the given field number, including the members of inherited objects.
+		// Returns false if the object has no such member.
+		template <typename Formatter>
+		bool load_field(Formatter& formatter, O& object, scts::in_stream& stream, std::uint32_t field_number) const {
+			// Otherwise a member of a parent would never be read, since the members of the object are looked up first.
+			static_assert(field_lookup_detail::all_unique(field_numbers()), "field numbers need to be unique across the object and its parents");
+			return Members::load_field(formatter, object, stream, field_number) || InheritsFrom::read_field(formatter, object, stream, field_number);
 		}
 
+		// Calls f with a default constructed member<> for each member of the object, starting with those of its parents.
+		// The members are in the order that formatters write them.
+		template <typename F>
+		static void for_each_member(F&& f) {
+			InheritsFrom::for_each_member(f);
+			Members::for_each_member(f);
+		}
+
+		// Like for_each_member, but also passes the name of each member. The names are empty if the descriptor has none.
+		template <typename F>
+		void for_each_named_member(F&& f) const {
+			InheritsFrom::for_each_named_member(f);
+			Members::for_each_named_member(f, m_names);
+		}
+
+		// A hash of the member types and names of the object and its parents. Changes whenever the descriptor does.
+		constexpr std::uint64_t fingerprint() const noexcept { return m_fingerprint; }
+
 		const bool has_names;
 	private:
+		using name_lookup = scts::name_lookup<Members::member_count>;
+
+		static constexpr std::uint64_t compute_fingerprint(const typename Members::name_container& names, bool include_names) noexcept {
+			auto hash = combine_fingerprint(InheritsFrom::fingerprint(), Members::fingerprint());
+			if (include_names) {
+				for (const auto name : names) hash = combine_fingerprint(hash, hash_name(name));
+			}
+			return hash;
+		}
+
 		const typename Members::name_container m_names;
+		// Compile time perfect hash of the names, used by formatters that dispatch members by name.
+		const name_lookup m_lookup;
+		const std::uint64_t m_fingerprint;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+
+#include "stream.h"
+#include "binary_encoding.h"
+
+namespace scts {
+	struct invalid_protobuf : std::exception {
+		invalid_protobuf(std::size_t position) : m_String("Invalid protobuf at position " + std::to_string(position)) { }
+		const char* what() const noexcept override { return m_String.c_str(); }
+	private:
+		const std::string m_String;
+	};
+
+	// The wire types of protobuf, and how the builtin types map onto them. Every field starts with a varint tag holding
+	// the field number shifted left by three bits and the wire type in the lowest three bits.
+	// Signed integers and enums are int32/int64 (not zigzag encoded), unsigned integers uint32/uint64,
+	// float is float and double is double. Vectors of single byte numbers are bytes.
+	struct protobuf_wire {
+		static constexpr std::uint8_t varint = 0;
+		static constexpr std::uint8_t fixed64 = 1;
+		static constexpr std::uint8_t length_delimited = 2;
+		static constexpr std::uint8_t start_group = 3;
+		static constexpr std::uint8_t end_group = 4;
+		static constexpr std::uint8_t fixed32 = 5;
+
+		static constexpr std::uint32_t max_field_number = (1u << 29) - 1;
+
+		template <typename T>
+		static constexpr bool is_byte = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) == 1;
+
+		// Numbers and enums can be repeated as packed fields, one length delimited run of values without tags.
+		template <typename T>
+		static constexpr bool is_packable = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+		template <typename T>
+		static constexpr std::uint8_t wire_type_of() noexcept {
+			if constexpr (std::is_same_v<T, float>) return fixed32;
+			else if constexpr (std::is_floating_point_v<T>) return fixed64;
+			else if constexpr (is_packable<T>) return varint;
+			else return length_delimited;
+		}
+
+		// Protobuf has no repeated fields of repeated fields, so containers can't hold containers.
+		template <typename T>
+		struct is_repeated : std::false_type { };
+		template <typename T>
+		struct is_repeated<std::vector<T>> : std::true_type { };
+		template <typename T, std::size_t C>
+		struct is_repeated<std::array<T, C>> : std::true_type { };
+		template <typename T, std::size_t C>
+		struct is_repeated<T[C]> : std::true_type { };
+		template <typename V>
+		struct is_repeated<std::map<std::string, V>> : std::true_type { };
+
+		template <typename T>
+		static constexpr bool is_repeated_v = is_repeated<T>::value;
+
+		static std::uint32_t tag_of(std::uint32_t field_number, std::uint8_t wire_type) noexcept {
+			return field_number << 3 | wire_type;
+		}
+	};
+}
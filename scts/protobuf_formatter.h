@@ -0,0 +1,11 @@
+#pragma once
+
+#include "protobuf_writer.h"
+#include "protobuf_reader.h"
+
+namespace scts {
+	struct protobuf_formatter : protobuf_writer, protobuf_reader {
+		static constexpr bool requires_names = false;
+		static constexpr bool uses_field_numbers = true;
+	};
+}
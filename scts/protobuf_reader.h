@@ -0,0 +1,291 @@
+#pragma once
+
+#include <limits>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "stream.h"
+#include "helpers.h"
+#include "builtin_types.h"
+#include "binary_encoding.h"
+#include "protobuf_encoding.h"
+
+namespace scts {
+	// Reads the protobuf wire format. Fields are dispatched through the compile time field number table of the
+	// object descriptor, and fields with unknown numbers are skipped by their wire type without being decoded.
+	// As in protobuf, fields missing from the input have their default value: the members of the object being read
+	// are reset first. Raw pointers are not reset: present fields are read into what they point to, or allocated if they are null.
+	// Repeated fields accept both packed and unpacked values, and repeated occurrences of the same
+	// field are appended to vectors and merged into messages.
+	struct protobuf_reader {
+		static constexpr bool requires_names = false;
+		static constexpr bool uses_field_numbers = true;
+
+		protobuf_reader() noexcept = default;
+
+		static void prepare_read(scts::in_stream&) { }
+
+		// Reads all fields up to the end of the stream, calling read_field(field_number) for each of them with
+		// the stream positioned at its value. The callback returns false if it did not consume the value.
+		template <typename O, typename Callback>
+		void read_fields(O& object, scts::in_stream& stream, Callback&& read_field) {
+			if (!m_merge) {
+				scts::register_type<O>::descriptor.for_each_member([&](auto member) {
+					reset_value(decltype(member)::get(object));
+				});
+			}
+			read_tags(stream, read_field);
+		}
+
+		template <typename T>
+		void read_member(T& member, scts::in_stream& stream) {
+			field_reader<T>::read(*this, member, stream);
+		}
+	private:
+		// Messages nested in another message are merged into, since they were already reset together with their parent.
+		explicit protobuf_reader(bool merge) noexcept : m_merge(merge) { }
+
+		// Raw pointers are left alone, since readers don't own what they point to.
+		template <typename T>
+		static void reset_value([[maybe_unused]] T& value) {
+			if constexpr (std::is_array_v<T>) {
+				for (auto& element : value) reset_value(element);
+			}
+			else if constexpr (!std::is_pointer_v<T>) {
+				value = T{};
+			}
+		}
+
+		template <typename Callback>
+		void read_tags(scts::in_stream& stream, Callback& read_field) {
+			while (!stream.empty()) {
+				m_tag_position = stream.position();
+				const auto tag = varint_encoding::read_varint(stream);
+				const auto field_number = tag >> 3;
+				if (field_number == 0 || field_number > protobuf_wire::max_field_number) throw invalid_protobuf(m_tag_position);
+				m_wire_type = static_cast<std::uint8_t>(tag & 7);
+				if (!read_field(static_cast<std::uint32_t>(field_number))) skip_field(m_wire_type, field_number, stream);
+			}
+		}
+
+		void expect(std::uint8_t wire_type) const {
+			if (m_wire_type != wire_type) throw invalid_protobuf(m_tag_position);
+		}
+
+		static std::string_view read_length_delimited(scts::in_stream& stream) {
+			const auto length = varint_encoding::read_varint(stream);
+			if (length > stream.remaining()) throw unexpected_end_of_stream();
+			return stream.read(static_cast<std::size_t>(length));
+		}
+
+		// Skips a field without decoding it: varints are scanned for their last byte, everything else has a known size.
+		static void skip_field(std::uint8_t wire_type, std::uint64_t field_number, scts::in_stream& stream) {
+			switch (wire_type) {
+			case protobuf_wire::varint:
+				while (static_cast<std::uint8_t>(stream.get()) & 0x80) { }
+				break;
+			case protobuf_wire::fixed64: stream.advance(8); break;
+			case protobuf_wire::length_delimited: read_length_delimited(stream); break;
+			case protobuf_wire::fixed32: stream.advance(4); break;
+			case protobuf_wire::start_group:
+				// Groups are deprecated, but still skipped up to the end group with the same field number.
+				for (;;) {
+					const auto position = stream.position();
+					const auto tag = varint_encoding::read_varint(stream);
+					const auto type = static_cast<std::uint8_t>(tag & 7);
+					if (type == protobuf_wire::end_group) {
+						if ((tag >> 3) != field_number) throw invalid_protobuf(position);
+						break;
+					}
+					skip_field(type, tag >> 3, stream);
+				}
+				break;
+			default:
+				throw invalid_protobuf(stream.position());
+			}
+		}
+
+		template <typename T>
+		T read_scalar(scts::in_stream& stream) const {
+			if constexpr (std::is_enum_v<T>) {
+				return static_cast<T>(read_scalar<std::underlying_type_t<T>>(stream));
+			}
+			else if constexpr (std::is_same_v<T, bool>) {
+				return varint_encoding::read_varint(stream) != 0;
+			}
+			else if constexpr (std::is_same_v<T, float>) {
+				return little_endian_encoding::read<float>(stream);
+			}
+			else if constexpr (std::is_floating_point_v<T>) {
+				return static_cast<T>(little_endian_encoding::read<double>(stream));
+			}
+			else {
+				const auto position = stream.position();
+				const auto value = varint_encoding::read_varint(stream);
+				if constexpr (std::is_signed_v<T>) {
+					const auto signed_value = static_cast<std::int64_t>(value);
+					if (signed_value < std::numeric_limits<T>::min() || signed_value > std::numeric_limits<T>::max()) throw invalid_protobuf(position);
+					return static_cast<T>(signed_value);
+				}
+				else {
+					if (value > std::numeric_limits<T>::max()) throw invalid_protobuf(position);
+					return static_cast<T>(value);
+				}
+			}
+		}
+
+		// Appends the values of a packed field, or the single value of an unpacked one.
+		template <typename T, typename Values>
+		void read_repeated_values(Values& values, scts::in_stream& stream) const {
+			if (m_wire_type != protobuf_wire::length_delimited) {
+				expect(protobuf_wire::wire_type_of<T>());
+				values.push_back(read_scalar<T>(stream));
+				return;
+			}
+			scts::in_stream packed(read_length_delimited(stream));
+			if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+				if (packed.size() % sizeof(T) != 0) throw invalid_protobuf(m_tag_position);
+				const auto offset = values.size();
+				values.resize(offset + packed.size() / sizeof(T));
+				little_endian_encoding::read_values(values.data() + offset, values.size() - offset, packed);
+			}
+			else {
+				while (!packed.empty()) values.push_back(read_scalar<T>(packed));
+			}
+		}
+
+		// Fixed size arrays are a single packed field holding exactly as many values as the array.
+		template <typename T, std::size_t C>
+		void read_fixed_values(T* values, scts::in_stream& stream) const {
+			expect(protobuf_wire::length_delimited);
+			if constexpr (protobuf_wire::is_byte<T>) {
+				const auto bytes = read_length_delimited(stream);
+				if (bytes.size() != C) throw invalid_protobuf(m_tag_position);
+				std::memcpy(values, bytes.data(), C);
+			}
+			else {
+				scts::in_stream packed(read_length_delimited(stream));
+				if constexpr (std::is_floating_point_v<T>) {
+					if (packed.size() != C * (std::is_same_v<T, float> ? 4 : 8)) throw invalid_protobuf(m_tag_position);
+				}
+				std::size_t count = 0;
+				while (!packed.empty()) {
+					const auto value = read_scalar<T>(packed);
+					if (count == C) throw invalid_protobuf(m_tag_position);
+					values[count++] = value;
+				}
+				if (count != C) throw invalid_protobuf(m_tag_position);
+			}
+		}
+
+		// Strings, arithmetic types and registered types.
+		template <typename T, typename = void>
+		struct field_reader {
+			static void read(protobuf_reader& reader, T& value, scts::in_stream& stream) {
+				reader.expect(protobuf_wire::wire_type_of<T>());
+				if constexpr (std::is_same_v<T, std::string>) {
+					value = std::string(read_length_delimited(stream));
+				}
+				else if constexpr (is_builtin_type_v<T>) {
+					value = reader.read_scalar<T>(stream);
+				}
+				else {
+					scts::in_stream message(read_length_delimited(stream));
+					protobuf_reader nested(true);
+					scts::register_type<T>::descriptor.load(nested, value, message);
+				}
+			}
+		};
+
+		// Enums.
+		template <typename Enum>
+		struct field_reader<Enum, std::enable_if_t<std::is_enum_v<Enum>>> {
+			static void read(protobuf_reader& reader, Enum& value, scts::in_stream& stream) {
+				reader.expect(protobuf_wire::varint);
+				value = reader.read_scalar<Enum>(stream);
+			}
+		};
+
+		// C-style pointers and arrays.
+		template <typename T>
+		struct field_reader<T*> {
+			static void read(protobuf_reader& reader, T*& value, scts::in_stream& stream) {
+				field_reader<T>::read(reader, scts::existing_or_allocated_pointee(value), stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct field_reader<T[C]> {
+			static void read(protobuf_reader& reader, T(&values)[C], scts::in_stream& stream) {
+				reader.read_fixed_values<T, C>(values, stream);
+			}
+		};
+
+		// Standard library containers and classes.
+		template <typename T>
+		struct field_reader<std::vector<T>> {
+			static void read(protobuf_reader& reader, std::vector<T>& values, scts::in_stream& stream) {
+				if constexpr (protobuf_wire::is_byte<T>) {
+					reader.expect(protobuf_wire::length_delimited);
+					const auto bytes = read_length_delimited(stream);
+					values.assign(bytes.begin(), bytes.end());
+				}
+				else if constexpr (protobuf_wire::is_packable<T>) {
+					reader.read_repeated_values<T>(values, stream);
+				}
+				else {
+					field_reader<T>::read(reader, values.emplace_back(), stream);
+				}
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct field_reader<std::array<T, C>> {
+			static void read(protobuf_reader& reader, std::array<T, C>& values, scts::in_stream& stream) {
+				reader.read_fixed_values<T, C>(values.data(), stream);
+			}
+		};
+
+		template <typename V>
+		struct field_reader<std::map<std::string, V>> {
+			static void read(protobuf_reader& reader, std::map<std::string, V>& values, scts::in_stream& stream) {
+				reader.expect(protobuf_wire::length_delimited);
+				scts::in_stream entry(read_length_delimited(stream));
+				std::string key;
+				V value{};
+				protobuf_reader entry_reader(true);
+				auto read_entry_field = [&](std::uint32_t field_number) {
+					if (field_number == 1) field_reader<std::string>::read(entry_reader, key, entry);
+					else if (field_number == 2) field_reader<V>::read(entry_reader, value, entry);
+					else return false;
+					return true;
+				};
+				entry_reader.read_tags(entry, read_entry_field);
+				values.insert_or_assign(std::move(key), std::move(value));
+			}
+		};
+
+		template <typename T>
+		struct field_reader<std::optional<T>> {
+			static void read(protobuf_reader& reader, std::optional<T>& value, scts::in_stream& stream) {
+				if (!value.has_value()) value.emplace();
+				field_reader<T>::read(reader, value.value(), stream);
+			}
+		};
+
+		// Standard library smart pointers.
+		template <typename T>
+		struct field_reader<std::unique_ptr<T>> {
+			static void read(protobuf_reader& reader, std::unique_ptr<T>& value, scts::in_stream& stream) {
+				if (value == nullptr) value = std::make_unique<T>();
+				field_reader<T>::read(reader, *value.get(), stream);
+			}
+		};
+
+		bool m_merge = false;
+		std::uint8_t m_wire_type = 0;
+		std::size_t m_tag_position = 0;
+	};
+}
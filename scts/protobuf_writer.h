@@ -0,0 +1,267 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "stream.h"
+#include "builtin_types.h"
+#include "binary_encoding.h"
+#include "protobuf_encoding.h"
+
+namespace scts {
+	// Writes registered types in the protobuf wire format, using the field numbers of their members.
+	// Like proto3, fields holding their default value (zero, empty strings and containers, null pointers, empty optionals)
+	// are left out. Present optionals and pointers are written even if their value is the default.
+	// Vectors and arrays of numbers are packed, other vectors are repeated fields and maps are repeated entries.
+	struct protobuf_writer {
+		static constexpr bool requires_names = false;
+		static constexpr bool uses_field_numbers = true;
+
+		static void prepare_write(scts::out_stream&) { }
+		static void post_write(scts::out_stream&) { }
+
+		template <typename T>
+		static void write_field(const T& value, scts::out_stream& stream, std::uint32_t field_number) {
+			static_assert(scts::is_serializable_v<T>);
+
+			if (!field_writer<T>::is_default(value)) field_writer<T>::write(value, field_number, stream);
+		}
+
+		// The members of parents are fields of the same message.
+		static void write_inherited_object_separator(scts::out_stream&) { }
+	private:
+		static void write_tag(std::uint32_t field_number, std::uint8_t wire_type, scts::out_stream& stream) {
+			varint_encoding::write_varint(protobuf_wire::tag_of(field_number, wire_type), stream);
+		}
+
+		static std::size_t varint_size(std::uint64_t value) noexcept {
+			std::size_t size = 1;
+			while (value >= 0x80) {
+				value >>= 7;
+				size++;
+			}
+			return size;
+		}
+
+		// Most payloads are shorter than 128 bytes, so a single byte is reserved for the length,
+		// and the payload is only moved if its length turns out to need more.
+		template <typename F>
+		static void write_length_delimited(scts::out_stream& stream, F&& write_payload) {
+			const auto start = stream.size();
+			stream.push_back('\0');
+			write_payload();
+			auto length = stream.size() - start - 1;
+			const auto length_size = varint_size(length);
+			if (length_size > 1) {
+				stream.prepare(length_size - 1);
+				stream.commit(length_size - 1);
+				std::memmove(stream.data() + start + length_size, stream.data() + start + 1, length);
+			}
+			auto bytes = stream.data() + start;
+			while (length >= 0x80) {
+				*bytes++ = static_cast<char>(length | 0x80);
+				length >>= 7;
+			}
+			*bytes = static_cast<char>(length);
+		}
+
+		static void write_bytes(const char* bytes, std::size_t size, scts::out_stream& stream) {
+			varint_encoding::write_varint(size, stream);
+			stream.append(bytes, size);
+		}
+
+		template <typename T>
+		static void write_scalar(T value, scts::out_stream& stream) {
+			if constexpr (std::is_enum_v<T>) {
+				write_scalar(static_cast<std::underlying_type_t<T>>(value), stream);
+			}
+			else if constexpr (std::is_same_v<T, bool>) {
+				stream.push_back(value ? '\1' : '\0');
+			}
+			else if constexpr (std::is_same_v<T, float>) {
+				little_endian_encoding::write(value, stream);
+			}
+			else if constexpr (std::is_floating_point_v<T>) {
+				little_endian_encoding::write(static_cast<double>(value), stream);
+			}
+			else if constexpr (std::is_signed_v<T>) {
+				// Negative numbers are sign extended to ten bytes, as int32 and int64 are.
+				varint_encoding::write_varint(static_cast<std::uint64_t>(static_cast<std::int64_t>(value)), stream);
+			}
+			else {
+				varint_encoding::write_varint(value, stream);
+			}
+		}
+
+		template <typename T>
+		struct repeated_writer {
+			static_assert(!protobuf_wire::is_repeated_v<T>, "protobuf has no repeated fields of repeated fields");
+
+			template <typename Iterator>
+			static void write(Iterator begin, std::size_t size, std::uint32_t field_number, scts::out_stream& stream) {
+				if constexpr (protobuf_wire::is_byte<T>) {
+					write_tag(field_number, protobuf_wire::length_delimited, stream);
+					write_bytes(size == 0 ? nullptr : reinterpret_cast<const char*>(&*begin), size, stream);
+				}
+				else if constexpr (protobuf_wire::is_packable<T>) {
+					write_tag(field_number, protobuf_wire::length_delimited, stream);
+					if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+						varint_encoding::write_varint(size * sizeof(T), stream);
+						little_endian_encoding::write_values(size == 0 ? nullptr : &*begin, size, stream);
+					}
+					else {
+						write_length_delimited(stream, [&] {
+							for (std::size_t i = 0; i < size; ++i, ++begin) write_scalar<T>(*begin, stream);
+						});
+					}
+				}
+				else {
+					// Elements of repeated fields are written even if they hold the default value.
+					for (std::size_t i = 0; i < size; ++i, ++begin) field_writer<T>::write(*begin, field_number, stream);
+				}
+			}
+		};
+
+		// Strings, arithmetic types and registered types.
+		template <typename T, typename = void>
+		struct field_writer {
+			static bool is_default(const T& value) {
+				if constexpr (std::is_same_v<T, std::string>) return value.empty();
+				else if constexpr (std::is_floating_point_v<T>) return value == T{} && !std::signbit(value);
+				else if constexpr (std::is_arithmetic_v<T>) return value == T{};
+				else return false;
+			}
+
+			static void write(const T& value, std::uint32_t field_number, scts::out_stream& stream) {
+				write_tag(field_number, protobuf_wire::wire_type_of<T>(), stream);
+				if constexpr (std::is_same_v<T, std::string>) {
+					write_bytes(value.data(), value.size(), stream);
+				}
+				else if constexpr (is_builtin_type_v<T>) {
+					write_scalar(value, stream);
+				}
+				else {
+					write_length_delimited(stream, [&] {
+						protobuf_writer writer;
+						scts::register_type<T>::descriptor.save(writer, value, stream);
+					});
+				}
+			}
+		};
+
+		// Enums.
+		template <typename Enum>
+		struct field_writer<Enum, std::enable_if_t<std::is_enum_v<Enum>>> {
+			static bool is_default(const Enum& value) {
+				return value == Enum{};
+			}
+
+			static void write(const Enum& value, std::uint32_t field_number, scts::out_stream& stream) {
+				write_tag(field_number, protobuf_wire::varint, stream);
+				write_scalar(value, stream);
+			}
+		};
+
+		// C-style pointers and arrays.
+		template <typename T>
+		struct field_writer<T*> {
+			static_assert(!protobuf_wire::is_repeated_v<T>, "protobuf has no optional repeated fields");
+
+			static bool is_default(const T* value) {
+				return value == nullptr;
+			}
+
+			static void write(const T* value, std::uint32_t field_number, scts::out_stream& stream) {
+				field_writer<T>::write(*value, field_number, stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct field_writer<T[C]> {
+			static_assert(protobuf_wire::is_packable<T>, "fixed size arrays need to hold numbers, which are written as packed fields");
+
+			static bool is_default(const T(&)[C]) {
+				return C == 0;
+			}
+
+			static void write(const T(&values)[C], std::uint32_t field_number, scts::out_stream& stream) {
+				repeated_writer<T>::write(std::begin(values), C, field_number, stream);
+			}
+		};
+
+		// Standard library containers and classes.
+		template <typename T>
+		struct field_writer<std::vector<T>> {
+			static bool is_default(const std::vector<T>& values) {
+				return values.empty();
+			}
+
+			static void write(const std::vector<T>& values, std::uint32_t field_number, scts::out_stream& stream) {
+				repeated_writer<T>::write(values.begin(), values.size(), field_number, stream);
+			}
+		};
+
+		template <typename T, std::size_t C>
+		struct field_writer<std::array<T, C>> {
+			static_assert(protobuf_wire::is_packable<T>, "fixed size arrays need to hold numbers, which are written as packed fields");
+
+			static bool is_default(const std::array<T, C>&) {
+				return C == 0;
+			}
+
+			static void write(const std::array<T, C>& values, std::uint32_t field_number, scts::out_stream& stream) {
+				repeated_writer<T>::write(values.begin(), C, field_number, stream);
+			}
+		};
+
+		// Maps are repeated messages holding the key as field 1 and the value as field 2.
+		template <typename V>
+		struct field_writer<std::map<std::string, V>> {
+			static_assert(!protobuf_wire::is_repeated_v<V>, "protobuf has no maps of repeated fields");
+
+			static bool is_default(const std::map<std::string, V>& values) {
+				return values.empty();
+			}
+
+			static void write(const std::map<std::string, V>& values, std::uint32_t field_number, scts::out_stream& stream) {
+				for (const auto& [key, value] : values) {
+					write_tag(field_number, protobuf_wire::length_delimited, stream);
+					write_length_delimited(stream, [&] {
+						write_field(key, stream, 1);
+						write_field(value, stream, 2);
+					});
+				}
+			}
+		};
+
+		template <typename T>
+		struct field_writer<std::optional<T>> {
+			static_assert(!protobuf_wire::is_repeated_v<T>, "protobuf has no optional repeated fields");
+
+			static bool is_default(const std::optional<T>& value) {
+				return !value.has_value();
+			}
+
+			static void write(const std::optional<T>& value, std::uint32_t field_number, scts::out_stream& stream) {
+				field_writer<T>::write(value.value(), field_number, stream);
+			}
+		};
+
+		// Standard library smart pointers.
+		template <typename T>
+		struct field_writer<std::unique_ptr<T>> {
+			static_assert(!protobuf_wire::is_repeated_v<T>, "protobuf has no optional repeated fields");
+
+			static bool is_default(const std::unique_ptr<T>& value) {
+				return value == nullptr;
+			}
+
+			static void write(const std::unique_ptr<T>& value, std::uint32_t field_number, scts::out_stream& stream) {
+				field_writer<T>::write(*value, field_number, stream);
+			}
+		};
+	};
+}
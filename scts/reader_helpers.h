@@ -0,0 +1,57 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#include "stream.h"
+
+namespace scts {
+	// Shared by the readers of formats that carry their own lengths and number types, which come from untrusted input.
+	namespace reader_helpers {
+		// Converts an integer from the input to T, which it needs to fit into unless T is a floating point type.
+		// Throws Error with the position of the integer otherwise.
+		template <typename T, typename Error, typename I>
+		T to_integer(I value, std::size_t position) {
+			if constexpr (!std::is_floating_point_v<T>) {
+				if constexpr (std::is_signed_v<I>) {
+					if (value < 0 ? !std::is_signed_v<T> || value < static_cast<std::int64_t>(std::numeric_limits<T>::min())
+						: static_cast<std::uint64_t>(value) > static_cast<std::uint64_t>(std::numeric_limits<T>::max())) throw Error(position);
+				}
+				else {
+					if (value > static_cast<std::uint64_t>(std::numeric_limits<T>::max())) throw Error(position);
+				}
+			}
+			return static_cast<T>(value);
+		}
+
+		// Lengths come from the input, so they are not trusted for allocating more than the input could possibly hold.
+		inline std::size_t plausible_length(std::uint64_t length, const scts::in_stream& stream) {
+			return static_cast<std::size_t>(std::min<std::uint64_t>(length, stream.remaining()));
+		}
+
+		// ListReader::read(values, resize, stream) reads a list into values, after calling resize with its length.
+		template <typename ListReader, typename T>
+		void read_vector(std::vector<T>& values, scts::in_stream& stream) {
+			ListReader::read(values, [&](std::size_t count) {
+				values.clear();
+				values.reserve(plausible_length(count, stream));
+				values.resize(count);
+			}, stream);
+		}
+
+		// Reads a list that needs to hold exactly C values into a fixed size array, throwing Error if it doesn't.
+		template <typename ListReader, typename Error, std::size_t C, typename T>
+		void read_fixed_list(T* values, scts::in_stream& stream) {
+			const auto position = stream.position();
+			struct span {
+				T* first;
+				T* begin() const { return first; }
+				T* end() const { return first + C; }
+			} all{ values };
+			ListReader::read(all, [&](std::size_t count) { if (count != C) throw Error(position); }, stream);
+		}
+	}
+}
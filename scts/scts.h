@@ -3,4 +3,7 @@
 #include "stream.h"
 #include "serializer.h"
 #include "object_descriptor.h"
+#include "flat_view.h"
+#include "message_stream.h"
+#include "csv_stream.h"
 #include "register_type.h"
\ No newline at end of file
@@ -1,11 +1,13 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <string_view>
 #include <initializer_list>
 
 #include "stream.h"
 #include "formatters.h"
+#include "fingerprint.h"
 #include "register_type.h"
 
 namespace scts {
@@ -15,6 +17,9 @@ namespace scts {
 		static_assert(scts::is_valid_formatter_v<Formatter>, "formatter needs to be a valid formatter");
 
 		formatter.prepare_write(stream);
+		if constexpr (scts::formatter_checks_schema_v<Formatter>) {
+			formatter.write_fingerprint(scts::register_type<O>::descriptor.fingerprint(), stream);
+		}
 		scts::register_type<O>::descriptor.save(formatter, object, stream);
 		formatter.post_write(stream);
 		return stream;
@@ -27,20 +32,76 @@ namespace scts {
 		return stream;
 	}
 
+	// The input is only viewed, never copied. Anything convertible to an in_stream can be passed in,
+	// including std::string_view and (std::byte pointer, size) pairs.
 	template <typename O, typename Formatter = scts::json_formatter>
-	inline O& deserialize(O& object, const scts::in_stream& stream, Formatter formatter = Formatter()) {
+	inline O& deserialize(O& object, scts::in_stream stream, Formatter formatter = Formatter()) {
 		static_assert(scts::is_registered_type_v<O>, "cannot deserialize an object type that is not registerd");
 		static_assert(scts::is_valid_formatter_v<Formatter>, "formatter needs to be a valid formatter");
 
-		auto copy = stream;
-		formatter.prepare_read(copy);
-		return scts::register_type<O>::descriptor.load(formatter, object, copy);
+		formatter.prepare_read(stream);
+		if constexpr (scts::formatter_checks_schema_v<Formatter>) {
+			formatter.check_fingerprint(scts::register_type<O>::descriptor.fingerprint(), stream);
+		}
+		return scts::register_type<O>::descriptor.load(formatter, object, stream);
 	}
 
 	template <typename O, typename Formatter = scts::json_formatter>
-	inline O deserialize(const scts::in_stream& stream, Formatter formatter = Formatter()) {
+	inline O deserialize(scts::in_stream stream, Formatter formatter = Formatter()) {
 		O object;
 		deserialize(object, stream, formatter);
 		return object;
 	}
-}
\ No newline at end of file
+
+	// Deltas are checked against a different fingerprint than whole objects, so that one cannot be read as the other.
+	template <typename O>
+	inline constexpr std::uint64_t delta_fingerprint = scts::combine_fingerprint(scts::register_type<O>::descriptor.fingerprint(), scts::hash_name("delta"));
+
+	// Serializes only what changed between two snapshots of an object, for apply_delta to bring previous up to current.
+	template <typename O, typename Formatter = scts::json_formatter>
+	inline scts::out_stream& serialize_delta(const O& previous, const O& current, scts::out_stream& stream, Formatter formatter = Formatter()) {
+		static_assert(scts::is_registered_type_v<O>, "cannot serialize an object type that is not registerd");
+		static_assert(scts::is_valid_formatter_v<Formatter>, "formatter needs to be a valid formatter");
+
+		formatter.prepare_write(stream);
+		if constexpr (scts::formatter_checks_schema_v<Formatter>) {
+			formatter.write_fingerprint(delta_fingerprint<O>, stream);
+		}
+		formatter.write_delta(previous, current, stream);
+		formatter.post_write(stream);
+		return stream;
+	}
+
+	template <typename O, typename Formatter = scts::json_formatter>
+	inline scts::out_stream serialize_delta(const O& previous, const O& current, Formatter formatter = Formatter()) {
+		scts::out_stream stream;
+		serialize_delta(previous, current, stream, formatter);
+		return stream;
+	}
+
+	// Applies a delta from serialize_delta. The object needs to be equal to the previous snapshot the delta was taken against.
+	template <typename O, typename Formatter = scts::json_formatter>
+	inline O& apply_delta(O& object, scts::in_stream stream, Formatter formatter = Formatter()) {
+		static_assert(scts::is_registered_type_v<O>, "cannot deserialize an object type that is not registerd");
+		static_assert(scts::is_valid_formatter_v<Formatter>, "formatter needs to be a valid formatter");
+
+		formatter.prepare_read(stream);
+		if constexpr (scts::formatter_checks_schema_v<Formatter>) {
+			formatter.check_fingerprint(delta_fingerprint<O>, stream);
+		}
+		formatter.read_delta(object, stream);
+		return object;
+	}
+
+#if SCTS_HAS_SPAN
+	template <typename O, typename Formatter = scts::json_formatter>
+	inline O& deserialize(O& object, std::span<const std::byte> bytes, Formatter formatter = Formatter()) {
+		return deserialize(object, scts::in_stream(bytes.data(), bytes.size()), formatter);
+	}
+
+	template <typename O, typename Formatter = scts::json_formatter>
+	inline O deserialize(std::span<const std::byte> bytes, Formatter formatter = Formatter()) {
+		return deserialize<O>(scts::in_stream(bytes.data(), bytes.size()), formatter);
+	}
+#endif
+}
@@ -1,16 +1,196 @@
 #pragma once
 
-#include <sstream>
+#include <string>
+#include <memory>
+#include <utility>
+#include <cstring>
+#include <cstddef>
+#include <exception>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+
+#include "number_format.h"
+
+#if defined(__has_include)
+#if __has_include(<span>) && ((defined(_MSVC_LANG) && _MSVC_LANG > 201703L) || __cplusplus > 201703L)
+#include <span>
+#define SCTS_HAS_SPAN 1
+#endif
+#endif
 
 namespace scts {
-	using in_stream = std::string;
+	struct unexpected_end_of_stream : std::exception {
+		const char* what() const noexcept override { return "Unexpected end of stream"; }
+	};
+
+	// A read cursor over serialized data. Reading advances an offset instead of consuming the data itself,
+	// so the stream never owns or copies what it reads. The viewed data needs to outlive the stream.
+	struct in_stream {
+		in_stream() noexcept = default;
+		in_stream(std::string_view data) noexcept : m_data(data) { }
+		// Only views the string, which needs to outlive the stream. A temporary string is fine as an argument
+		// that is read within the same expression, but not for a stream that is kept around.
+		in_stream(const std::string& data) noexcept : m_data(data) { }
+		in_stream(const char* data) noexcept : m_data(data) { }
+		in_stream(const std::byte* data, std::size_t size) noexcept : m_data(reinterpret_cast<const char*>(data), size) { }
+
+		std::size_t size() const noexcept { return m_data.size(); }
+		std::size_t position() const noexcept { return m_position; }
+		std::size_t remaining() const noexcept { return m_data.size() - m_position; }
+		bool empty() const noexcept { return m_position == m_data.size(); }
+
+		// The complete viewed data, and the part of it that has not been read yet.
+		std::string_view data() const noexcept { return m_data; }
+		std::string_view rest() const noexcept { return m_data.substr(m_position); }
+
+		char peek() const {
+			require(1);
+			return m_data[m_position];
+		}
+
+		char get() {
+			require(1);
+			return m_data[m_position++];
+		}
+
+		std::string_view read(std::size_t count) {
+			require(count);
+			const auto bytes = m_data.substr(m_position, count);
+			m_position += count;
+			return bytes;
+		}
+
+		void advance(std::size_t count) {
+			require(count);
+			m_position += count;
+		}
+
+		void seek(std::size_t position) {
+			if (position > m_data.size()) throw unexpected_end_of_stream();
+			m_position = position;
+		}
+	private:
+		void require(std::size_t count) const {
+			if (remaining() < count) throw unexpected_end_of_stream();
+		}
+
+		std::string_view m_data;
+		std::size_t m_position = 0;
+	};
+
+	// A contiguous, growable buffer the formatters write their output into.
+	// Unlike a std::stringstream there is no locale or sentry machinery involved, bytes are copied straight in.
+	struct byte_buffer {
+		byte_buffer() noexcept = default;
+		explicit byte_buffer(std::size_t capacity) { reserve(capacity); }
+
+		byte_buffer(const byte_buffer& other) : byte_buffer(other.m_size) {
+			append(other.data(), other.size());
+		}
 
-	struct out_stream : std::stringstream {
-		static constexpr std::streamsize max_precision = 100;
+		byte_buffer(byte_buffer&& other) noexcept
+			: m_data(std::move(other.m_data)), m_size(other.m_size), m_capacity(other.m_capacity) {
+			other.m_size = 0;
+			other.m_capacity = 0;
+		}
 
-		out_stream() { precision(max_precision); }
-		out_stream(const out_stream& stream) { str(stream.str()); }
+		byte_buffer& operator=(const byte_buffer& other) {
+			if (this != &other) {
+				clear();
+				append(other.data(), other.size());
+			}
+			return *this;
+		}
 
-		in_stream get_in_stream() const { return str(); }
+		byte_buffer& operator=(byte_buffer&& other) noexcept {
+			m_data = std::move(other.m_data);
+			m_size = std::exchange(other.m_size, 0);
+			m_capacity = std::exchange(other.m_capacity, 0);
+			return *this;
+		}
+
+		// Capacity control.
+		void reserve(std::size_t capacity) {
+			if (capacity <= m_capacity) return;
+			std::unique_ptr<char[]> data(new char[capacity]);
+			if (m_size > 0) std::memcpy(data.get(), m_data.get(), m_size);
+			m_data = std::move(data);
+			m_capacity = capacity;
+		}
+
+		void clear() noexcept { m_size = 0; }
+
+		std::size_t size() const noexcept { return m_size; }
+		std::size_t capacity() const noexcept { return m_capacity; }
+		bool empty() const noexcept { return m_size == 0; }
+
+		char* data() noexcept { return m_data.get(); }
+		const char* data() const noexcept { return m_data.get(); }
+
+		// Writing.
+		void append(const char* bytes, std::size_t count) {
+			if (count == 0) return;
+			grow_for(count);
+			std::memcpy(m_data.get() + m_size, bytes, count);
+			m_size += count;
+		}
+
+		void append(std::string_view bytes) { append(bytes.data(), bytes.size()); }
+
+		void push_back(char byte) {
+			grow_for(1);
+			m_data[m_size++] = byte;
+		}
+
+		// Direct writing: prepare returns space for at most max_count bytes at the end of the buffer,
+		// and commit then appends the count bytes that were actually written there.
+		char* prepare(std::size_t max_count) {
+			grow_for(max_count);
+			return m_data.get() + m_size;
+		}
+
+		void commit(std::size_t count) noexcept {
+			m_size += count;
+		}
+
+		// Drops everything after the first size bytes, for post-processing the output in place.
+		void truncate(std::size_t size) noexcept {
+			m_size = std::min(m_size, size);
+		}
+
+		byte_buffer& operator<<(char byte) { push_back(byte); return *this; }
+		byte_buffer& operator<<(signed char byte) { push_back(static_cast<char>(byte)); return *this; }
+		byte_buffer& operator<<(unsigned char byte) { push_back(static_cast<char>(byte)); return *this; }
+		byte_buffer& operator<<(bool value) { push_back(value ? '1' : '0'); return *this; }
+		byte_buffer& operator<<(std::string_view string) { append(string); return *this; }
+		byte_buffer& operator<<(const char* string) { append(std::string_view(string)); return *this; }
+		byte_buffer& operator<<(const std::string& string) { append(string.data(), string.size()); return *this; }
+
+		// Numbers are written as text, floating point numbers with the shortest representation that round trips.
+		template <typename T>
+		typename std::enable_if<std::is_arithmetic_v<T>, byte_buffer&>::type operator<<(T value) {
+			const auto begin = prepare(max_formatted_size<T>);
+			commit(static_cast<std::size_t>(format_number(begin, value) - begin));
+			return *this;
+		}
+
+		// Reading back what was written.
+		std::string_view view() const noexcept { return std::string_view(m_data.get(), m_size); }
+		std::string str() const { return std::string(m_data.get(), m_size); }
+		// Views the buffer without copying it, so the buffer needs to outlive the stream, and must not be written to
+		// while the stream is read. auto in = scts::serialize(a).get_in_stream(); dangles.
+		in_stream get_in_stream() const noexcept { return in_stream(view()); }
+	private:
+		void grow_for(std::size_t count) {
+			if (m_size + count <= m_capacity) return;
+			reserve(std::max(m_size + count, m_capacity * 2 + 64));
+		}
+
+		std::unique_ptr<char[]> m_data;
+		std::size_t m_size = 0;
+		std::size_t m_capacity = 0;
 	};
-}
\ No newline at end of file
+
+	using out_stream = byte_buffer;
+}
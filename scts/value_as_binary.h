@@ -1,9 +1,12 @@
 #pragma once
 
 #include "stream.h"
+#include "register_type.h"
 
 #include <array>
+#include <algorithm>
 #include <memory>
+#include <cstring>
 #include <type_traits>
 
 namespace scts {
@@ -23,10 +26,8 @@ namespace scts {
 		}
 
 		value_as_binary(scts::in_stream& stream) {
-			for (auto& b : m_bytes) {
-				b = stream.front();
-				stream.erase(0, 1);
-			}
+			const auto bytes = stream.read(size);
+			std::copy(bytes.begin(), bytes.end(), std::begin(m_bytes));
 		}
 
 		constexpr T value() const {
@@ -37,9 +38,39 @@ namespace scts {
 		}
 
 		void write(scts::out_stream& stream) const {
-			for (const auto b : m_bytes) { stream << b; }
+			stream.append(reinterpret_cast<const char*>(m_bytes.data()), size);
 		}
 	private:
 		std::array<byte, size> m_bytes;
 	};
-}
\ No newline at end of file
+
+	// Types for which every byte pattern is a valid value, so that contiguous runs of them can be copied as a whole.
+	// Registered types are bulk copyable when their descriptor says so.
+	template <typename T, typename = void>
+	struct is_bulk_copyable : std::bool_constant<(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>> { };
+
+	template <typename T>
+	inline constexpr bool is_bulk_copyable_v = is_bulk_copyable<T>::value;
+
+	template <typename T, std::size_t C>
+	struct is_bulk_copyable<T[C]> : is_bulk_copyable<T> { };
+	template <typename T, std::size_t C>
+	struct is_bulk_copyable<std::array<T, C>> : std::bool_constant<is_bulk_copyable_v<T> && sizeof(std::array<T, C>) == sizeof(T) * C> { };
+	template <typename T>
+	struct is_bulk_copyable<T, std::enable_if_t<is_registered_type_v<T>>>
+		: std::bool_constant<std::decay_t<decltype(register_type<T>::descriptor)>::is_bulk_copyable> { };
+
+	// Writes count values with one copy, producing the same bytes as writing each with value_as_binary.
+	template <typename T>
+	void write_bulk(const T* values, std::size_t count, scts::out_stream& stream) {
+		static_assert(is_bulk_copyable_v<T>);
+		stream.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+	}
+
+	template <typename T>
+	void read_bulk(T* values, std::size_t count, scts::in_stream& stream) {
+		static_assert(is_bulk_copyable_v<T>);
+		if (count > stream.remaining() / sizeof(T)) throw unexpected_end_of_stream();
+		if (count != 0) std::memcpy(values, stream.read(count * sizeof(T)).data(), count * sizeof(T));
+	}
+}
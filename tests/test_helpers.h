@@ -0,0 +1,58 @@
+#pragma once
+
+#include "catch.hpp"
+
+#include <string>
+#include <initializer_list>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+
+// Builds a string of the given byte values, to compare serialized output against.
+inline std::string bytes_of(std::initializer_list<int> bytes) {
+	std::string result;
+	for (auto byte : bytes) result.push_back(static_cast<char>(byte));
+	return result;
+}
+
+inline void close_descriptor(int descriptor) {
+#if defined(_WIN32)
+	_close(descriptor);
+#else
+	close(descriptor);
+#endif
+}
+
+// A pipe for the tests of writing to and reading from file descriptors. Both ends are closed on destruction.
+struct test_pipe {
+	test_pipe() {
+#if defined(_WIN32)
+		REQUIRE(_pipe(descriptors, 1 << 16, _O_BINARY) == 0);
+#else
+		REQUIRE(pipe(descriptors) == 0);
+#endif
+	}
+
+	test_pipe(const test_pipe&) = delete;
+	test_pipe& operator=(const test_pipe&) = delete;
+
+	~test_pipe() {
+		close_writing();
+		close_descriptor(descriptors[0]);
+	}
+
+	// Lets the reading end see the end of the input.
+	void close_writing() {
+		if (descriptors[1] >= 0) close_descriptor(descriptors[1]);
+		descriptors[1] = -1;
+	}
+
+	int reading() const { return descriptors[0]; }
+	int writing() const { return descriptors[1]; }
+
+	int descriptors[2] = { -1, -1 };
+};
@@ -79,4 +79,73 @@ template <> struct scts::register_type<complete_object> : scts::allow_serializat
 		scts::member<&complete_object::map_of_booleans>,
 		scts::member<&complete_object::optional_of_enum>,
 		scts::member<&complete_object::smart_ptr>>> descriptor{ "string", "boolean", "byte", "enumeration", "pointer", "c_array", "vector_of_objects", "array_of_doubles", "map_of_booleans", "optional_of_enum", "smart_ptr" };
-};
\ No newline at end of file
+};
+
+struct numeric_buffers {
+	std::vector<float> samples;
+	std::array<double, 3> weights;
+	int16_t offsets[4];
+	std::vector<state> states;
+
+	bool operator==(const numeric_buffers& other) const {
+		return samples == other.samples &&
+			weights == other.weights &&
+			std::equal(std::begin(offsets), std::end(offsets), std::begin(other.offsets)) &&
+			states == other.states;
+	}
+};
+
+template <> struct scts::register_type<numeric_buffers> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<numeric_buffers,
+		scts::members<
+		scts::member<&numeric_buffers::samples>,
+		scts::member<&numeric_buffers::weights>,
+		scts::member<&numeric_buffers::offsets>,
+		scts::member<&numeric_buffers::states>>> descriptor{ "samples", "weights", "offsets", "states" };
+};
+
+struct vector3 {
+	float x, y, z;
+
+	bool operator==(const vector3& other) const {
+		return x == other.x && y == other.y && z == other.z;
+	}
+};
+
+template <> struct scts::register_type<vector3> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<vector3,
+		scts::members<
+		scts::member<&vector3::x>,
+		scts::member<&vector3::y>,
+		scts::member<&vector3::z>>> descriptor{ "x", "y", "z" };
+};
+
+struct mesh {
+	vector3 origin;
+	std::vector<vector3> vertices;
+
+	bool operator==(const mesh& other) const {
+		return origin == other.origin && vertices == other.vertices;
+	}
+};
+
+template <> struct scts::register_type<mesh> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<mesh,
+		scts::members<
+		scts::member<&mesh::origin>,
+		scts::member<&mesh::vertices>>> descriptor{ "origin", "vertices" };
+};
+
+struct batch {
+	std::vector<derived_object> records;
+
+	bool operator==(const batch& other) const {
+		return records == other.records;
+	}
+};
+
+template <> struct scts::register_type<batch> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<batch,
+		scts::members<
+		scts::member<&batch::records>>> descriptor{ "records" };
+};
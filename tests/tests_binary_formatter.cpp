@@ -2,18 +2,59 @@
 
 #include "test_objects.h"
 
+namespace {
+	// Registered in a different order than its members are declared in.
+	struct reordered_pair {
+		int a;
+		int b;
+	};
+
+	struct reordered_pairs {
+		std::vector<reordered_pair> pairs;
+	};
+
+	struct marker {
+		bool operator==(const marker&) const { return true; }
+	};
+
+	struct markers {
+		std::vector<marker> values;
+	};
+}
+
+template <> struct scts::register_type<reordered_pair> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<reordered_pair,
+		scts::members<
+		scts::member<&reordered_pair::b>,
+		scts::member<&reordered_pair::a>>> descriptor{ "b", "a" };
+};
+
+template <> struct scts::register_type<reordered_pairs> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<reordered_pairs,
+		scts::members<scts::member<&reordered_pairs::pairs>>> descriptor{ "pairs" };
+};
+
+template <> struct scts::register_type<marker> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<marker, scts::members<>> descriptor{};
+};
+
+template <> struct scts::register_type<markers> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<markers,
+		scts::members<scts::member<&markers::values>>> descriptor{ "values" };
+};
+
 TEST_CASE("basic binary serialization and deserialization", "[binary_formatter]") {
 	base_object a{ 0.35, 12 };
 	auto a_stream = scts::serialize<base_object, scts::binary_formatter>(a);
 	base_object b;
-	scts::deserialize(b, a_stream.get_in_stream());
-	auto b_stream = scts::serialize(b);
+	scts::deserialize<base_object, scts::binary_formatter>(b, a_stream.get_in_stream());
+	auto b_stream = scts::serialize<base_object, scts::binary_formatter>(b);
 
 	REQUIRE(a == b);
 	REQUIRE(a_stream.str() == b_stream.str());
 }
 
-TEST_CASE("inheritance", "[binary_formatter]") {
+TEST_CASE("binary inheritance", "[binary_formatter]") {
 	derived_object a{ -124.1, 76, 0.15f, "hello" };
 	auto a_stream = scts::serialize<derived_object, scts::binary_formatter>(a);
 	derived_object b;
@@ -41,4 +82,280 @@ TEST_CASE("binary_formatter supports all required types", "[binary_formatter]")
 	auto serialized = scts::serialize<complete_object, scts::binary_formatter>(a);
 	auto b = scts::deserialize<complete_object, scts::binary_formatter>(serialized.get_in_stream());
 	REQUIRE(a == b);
-}
\ No newline at end of file
+}
+
+TEST_CASE("binary_formatter reads present optional values and pointers", "[binary_formatter]") {
+	complete_object a{
+		"",
+		false,
+		0,
+		state::idle,
+		new base_object{ 2.5, 3 },
+		{0.0f, 0.0f},
+		{},
+		{0.0, 0.0},
+		{},
+		state::moving,
+		std::make_unique<int>(-1)
+	};
+	auto serialized = scts::serialize<complete_object, scts::binary_formatter>(a);
+	complete_object b{};
+	scts::deserialize<complete_object, scts::binary_formatter>(b, serialized.get_in_stream());
+
+	REQUIRE(b.pointer != nullptr);
+	REQUIRE(*b.pointer == *a.pointer);
+	REQUIRE(b.optional_of_enum == state::moving);
+	REQUIRE(*b.smart_ptr == -1);
+
+	delete a.pointer;
+	delete b.pointer;
+}
+
+TEST_CASE("truncated binary input is rejected", "[binary_formatter]") {
+	derived_object a{ 1.0, 2, 3.0f, "string" };
+	auto serialized = scts::serialize<derived_object, scts::binary_formatter>(a);
+	const auto truncated = serialized.view().substr(0, serialized.size() - 1);
+
+	derived_object b;
+	REQUIRE_THROWS_AS((scts::deserialize<derived_object, scts::binary_formatter>(b, truncated)), scts::unexpected_end_of_stream);
+}
+
+TEST_CASE("binary contiguous numeric containers", "[binary_formatter]") {
+	numeric_buffers a{ {}, { 0.5, -1.0, 2.25 }, { -1, 2, -3, 4 }, { state::moving, state::idle } };
+	for (int i = 0; i < 1 << 20; ++i) a.samples.push_back(static_cast<float>(i) * 0.25f);
+
+	auto serialized = scts::serialize<numeric_buffers, scts::binary_formatter>(a);
+	REQUIRE(serialized.size() == 8 + 8 + a.samples.size() * sizeof(float) + sizeof(a.weights) + sizeof(a.offsets) + 8 + a.states.size() * sizeof(state));
+
+	// The payload is laid out as if written value by value.
+	float second;
+	std::memcpy(&second, serialized.data() + 8 + 8 + sizeof(float), sizeof(float));
+	REQUIRE(second == 0.25f);
+
+	numeric_buffers b;
+	scts::deserialize<numeric_buffers, scts::binary_formatter>(b, serialized.get_in_stream());
+	REQUIRE(a == b);
+
+	// A length that the rest of the input can not hold.
+	const auto truncated = serialized.view().substr(0, 8 + 8 + 16);
+	REQUIRE_THROWS_AS((scts::deserialize<numeric_buffers, scts::binary_formatter>(b, truncated)), scts::unexpected_end_of_stream);
+}
+
+TEST_CASE("binary bulk copyable objects", "[binary_formatter]") {
+	STATIC_REQUIRE(scts::register_type<vector3>::descriptor.is_bulk_copyable);
+	// Padding, parents and members that are not plain numbers all require writing member by member.
+	STATIC_REQUIRE_FALSE(scts::register_type<base_object>::descriptor.is_bulk_copyable);
+	STATIC_REQUIRE_FALSE(scts::register_type<derived_object>::descriptor.is_bulk_copyable);
+	STATIC_REQUIRE_FALSE(scts::register_type<mesh>::descriptor.is_bulk_copyable);
+
+	mesh a{ { 1.0f, 2.0f, 3.0f }, { { 0.5f, 0.0f, -0.5f }, { 4.0f, 5.0f, 6.0f } } };
+	auto serialized = scts::serialize<mesh, scts::binary_formatter>(a);
+	REQUIRE(serialized.size() == 8 + sizeof(vector3) + 8 + 2 * sizeof(vector3));
+
+	mesh b;
+	scts::deserialize<mesh, scts::binary_formatter>(b, serialized.get_in_stream());
+	REQUIRE(a == b);
+
+	// The bytes are the same as when written member by member.
+	const float members[] = { 1.0f, 2.0f, 3.0f };
+	REQUIRE(std::memcmp(serialized.data() + 8, members, sizeof(members)) == 0);
+}
+
+TEST_CASE("binary objects registered out of layout order are written in descriptor order", "[binary_formatter]") {
+	STATIC_REQUIRE_FALSE(scts::register_type<reordered_pair>::descriptor.is_bulk_copyable);
+
+	const reordered_pair a{ 1, 2 };
+	const auto serialized = scts::serialize<reordered_pair, scts::binary_formatter>(a);
+	const int members[] = { 2, 1 };
+	REQUIRE(serialized.size() == 8 + sizeof(members));
+	REQUIRE(std::memcmp(serialized.data() + 8, members, sizeof(members)) == 0);
+
+	const reordered_pairs c{ { { 1, 2 }, { 3, 4 } } };
+	const auto serialized_pairs = scts::serialize<reordered_pairs, scts::binary_formatter>(c);
+	const int pair_members[] = { 2, 1, 4, 3 };
+	REQUIRE(serialized_pairs.size() == 8 + 8 + sizeof(pair_members));
+	REQUIRE(std::memcmp(serialized_pairs.data() + 16, pair_members, sizeof(pair_members)) == 0);
+
+	const auto d = scts::deserialize<reordered_pairs, scts::binary_formatter>(serialized_pairs.get_in_stream());
+	REQUIRE(d.pairs.size() == 2);
+	REQUIRE(d.pairs[1].a == 3);
+	REQUIRE(d.pairs[1].b == 4);
+}
+
+TEST_CASE("compact binary round trip", "[binary_formatter]") {
+	complete_object a{
+		"cool{string[with]specialcharacters,",
+		true,
+		255,
+		state::moving,
+		nullptr,
+		{15.0f, -1.0f / 3.0f},
+		{base_object{1.0, -124}, base_object{-35.23, 0}},
+		{75.0, 98.0},
+		{{"key1", true}, {"key2", false}},
+		state::idle,
+		std::make_unique<int>(std::numeric_limits<int>::min())
+	};
+	auto compact = scts::serialize<complete_object, scts::compact_binary_formatter>(a);
+	auto fixed = scts::serialize<complete_object, scts::binary_formatter>(a);
+	REQUIRE(compact.size() < fixed.size());
+
+	auto b = scts::deserialize<complete_object, scts::compact_binary_formatter>(compact.get_in_stream());
+	REQUIRE(a == b);
+}
+
+TEST_CASE("compact binary encodes small integers in few bytes", "[binary_formatter]") {
+	derived_object a{ 0.5, -2, 1.0f, "abc" };
+	auto serialized = scts::serialize<derived_object, scts::compact_binary_formatter>(a);
+	// The fingerprint, the double, zigzag encoded -2, the float, and the string with its one byte length.
+	REQUIRE(serialized.size() == 8 + 8 + 1 + 4 + 1 + 3);
+	REQUIRE(static_cast<unsigned char>(serialized.data()[16]) == 3);
+
+	scts::out_stream stream;
+	scts::varint_encoding::write_varint(300, stream);
+	REQUIRE(stream.str() == "\xac\x02");
+	REQUIRE(scts::varint_encoding::zigzag_encode(-1) == 1);
+	REQUIRE(scts::varint_encoding::zigzag_encode(std::numeric_limits<std::int64_t>::min()) == std::numeric_limits<std::uint64_t>::max());
+	REQUIRE(scts::varint_encoding::zigzag_decode(std::numeric_limits<std::uint64_t>::max()) == std::numeric_limits<std::int64_t>::min());
+
+	for (std::uint64_t value : { std::uint64_t(0), std::uint64_t(127), std::uint64_t(128), std::numeric_limits<std::uint64_t>::max() }) {
+		scts::out_stream varint;
+		scts::varint_encoding::write_varint(value, varint);
+		auto in = varint.get_in_stream();
+		REQUIRE(scts::varint_encoding::read_varint(in) == value);
+		REQUIRE(in.empty());
+	}
+}
+
+TEST_CASE("compact binary rejects malformed varints", "[binary_formatter]") {
+	derived_object b;
+	// The fingerprint and the double.
+	const auto header = std::string(scts::serialize<derived_object, scts::compact_binary_formatter>(b).view().substr(0, 8)) + std::string(8, '\0');
+	// The integer does not fit in an int.
+	const std::string too_large = header + "\xff\xff\xff\xff\x7f";
+	REQUIRE_THROWS_AS((scts::deserialize<derived_object, scts::compact_binary_formatter>(b, too_large)), scts::invalid_varint);
+	// More than ten bytes.
+	const std::string too_long = header + std::string(10, '\xff') + '\x01';
+	REQUIRE_THROWS_AS((scts::deserialize<derived_object, scts::compact_binary_formatter>(b, too_long)), scts::invalid_varint);
+	// Ends in the middle of a varint.
+	const std::string truncated = header + '\x80';
+	REQUIRE_THROWS_AS((scts::deserialize<derived_object, scts::compact_binary_formatter>(b, truncated)), scts::unexpected_end_of_stream);
+}
+
+TEST_CASE("portable binary is little endian", "[binary_formatter]") {
+	STATIC_REQUIRE(scts::byte_swap(std::uint32_t(0x01020304)) == 0x04030201);
+	STATIC_REQUIRE(scts::byte_swap(std::uint16_t(0xff00)) == 0x00ff);
+
+	numeric_buffers a{ { 1.0f, -2.5f }, { 0.5, -1.0, 2.25 }, { 0x0102, 2, -3, 4 }, { state::moving } };
+	auto serialized = scts::serialize<numeric_buffers, scts::portable_binary_formatter>(a);
+	if constexpr (scts::host_is_little_endian) {
+		REQUIRE(serialized.str() == scts::serialize<numeric_buffers, scts::binary_formatter>(a).str());
+	}
+	// The length prefix of the samples, and the first of the offsets.
+	REQUIRE(serialized.view().substr(8, 8) == std::string_view("\x02\0\0\0\0\0\0\0", 8));
+	REQUIRE(serialized.view().substr(8 + 8 + 2 * sizeof(float) + 3 * sizeof(double), 2) == "\x02\x01");
+
+	numeric_buffers b;
+	scts::deserialize<numeric_buffers, scts::portable_binary_formatter>(b, serialized.get_in_stream());
+	REQUIRE(a == b);
+
+	std::uint16_t values[] = { 0x0102, 0x0304, 0x0506 };
+	scts::byte_swap_values<sizeof(std::uint16_t)>(reinterpret_cast<char*>(values), 3);
+	REQUIRE(values[0] == 0x0201);
+	REQUIRE(values[2] == 0x0605);
+}
+
+TEST_CASE("binary payloads carry the schema fingerprint", "[binary_formatter]") {
+	constexpr auto base = scts::register_type<base_object>::descriptor.fingerprint();
+	constexpr auto derived = scts::register_type<derived_object>::descriptor.fingerprint();
+	STATIC_REQUIRE(base != derived);
+	STATIC_REQUIRE(scts::type_fingerprint_v<float[3]> == scts::type_fingerprint_v<std::array<float, 3>>);
+	STATIC_REQUIRE(scts::type_fingerprint_v<std::uint32_t> != scts::type_fingerprint_v<std::int32_t>);
+
+	// Same member types, different names.
+	constexpr scts::object_descriptor<base_object, scts::members<scts::member<&base_object::data>, scts::member<&base_object::integer>>> renamed{ "data", "number" };
+	STATIC_REQUIRE(renamed.fingerprint() != base);
+
+	base_object a{ 1.5, 2 };
+	auto serialized = scts::serialize<base_object, scts::binary_formatter>(a);
+	std::uint64_t stored;
+	std::memcpy(&stored, serialized.data(), sizeof(stored));
+	REQUIRE(scts::to_little_endian(stored) == base);
+
+	derived_object b;
+	REQUIRE_THROWS_AS((scts::deserialize<derived_object, scts::binary_formatter>(b, serialized.get_in_stream())), scts::schema_mismatch);
+}
+
+TEST_CASE("columnar binary layout", "[binary_formatter]") {
+	complete_object a{
+		"columns",
+		true,
+		1,
+		state::idle,
+		nullptr,
+		{1.0f, 2.0f},
+		{},
+		{3.0, 4.0},
+		{},
+		std::nullopt,
+		std::make_unique<int>(0)
+	};
+	for (int i = 1; i <= 1000; ++i) a.vector_of_objects.push_back(base_object{ i * 0.5, -i });
+
+	auto serialized = scts::serialize<complete_object, scts::columnar_binary_formatter>(a);
+	auto rows = scts::serialize<complete_object, scts::binary_formatter>(a);
+	REQUIRE(serialized.size() == rows.size());
+
+	// All of the doubles come first, then all of the integers.
+	const auto column = serialized.view().find(std::string_view(reinterpret_cast<const char*>(&a.vector_of_objects[0].data), sizeof(double)));
+	REQUIRE(column != std::string_view::npos);
+	double second;
+	std::memcpy(&second, serialized.data() + column + sizeof(double), sizeof(double));
+	REQUIRE(second == 1.0);
+	int second_integer;
+	std::memcpy(&second_integer, serialized.data() + column + 1000 * sizeof(double) + sizeof(int), sizeof(int));
+	REQUIRE(second_integer == -2);
+
+	complete_object b{};
+	scts::deserialize<complete_object, scts::columnar_binary_formatter>(b, serialized.get_in_stream());
+	REQUIRE(a == b);
+
+	// Rows and columns are never mixed up.
+	REQUIRE_THROWS_AS((scts::deserialize<complete_object, scts::binary_formatter>(b, serialized.get_in_stream())), scts::schema_mismatch);
+}
+
+TEST_CASE("columnar binary layout of nested objects", "[binary_formatter]") {
+	mesh a{ { 1.0f, 2.0f, 3.0f }, { { 0.5f, 0.0f, -0.5f }, { 4.0f, 5.0f, 6.0f } } };
+	auto serialized = scts::serialize<mesh, scts::columnar_binary_formatter>(a);
+	// The x coordinates of the vertices are next to each other, after the fingerprint, the origin and the length.
+	float xs[2];
+	std::memcpy(xs, serialized.data() + 8 + sizeof(vector3) + 8, sizeof(xs));
+	REQUIRE(xs[0] == 0.5f);
+	REQUIRE(xs[1] == 4.0f);
+
+	mesh b;
+	scts::deserialize<mesh, scts::columnar_binary_formatter>(b, serialized.get_in_stream());
+	REQUIRE(a == b);
+}
+
+TEST_CASE("columnar binary layout of objects without members", "[binary_formatter]") {
+	markers a{ std::vector<marker>(3) };
+	auto serialized = scts::serialize<markers, scts::columnar_binary_formatter>(a);
+	markers b;
+	scts::deserialize<markers, scts::columnar_binary_formatter>(b, serialized.get_in_stream());
+	REQUIRE(b.values.size() == 3);
+}
+
+TEST_CASE("columnar binary layout with inheritance", "[binary_formatter]") {
+	batch a{ { { 1.0, 2, 3.0f, "first" }, { 4.0, 5, 6.0f, "second" } } };
+	auto serialized = scts::serialize<batch, scts::columnar_binary_formatter>(a);
+	// The columns of the parent come first.
+	double data[2];
+	std::memcpy(data, serialized.data() + 8 + 8, sizeof(data));
+	REQUIRE(data[0] == 1.0);
+	REQUIRE(data[1] == 4.0);
+
+	batch b;
+	scts::deserialize<batch, scts::columnar_binary_formatter>(b, serialized.get_in_stream());
+	REQUIRE(a == b);
+}
@@ -0,0 +1,126 @@
+#include "catch.hpp"
+
+#include "test_objects.h"
+#include "test_helpers.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+	// The tag of a typed array in host byte order, as cbor_writer writes it.
+	template <typename T>
+	char host_tag() {
+		return static_cast<char>(scts::cbor_type::typed_array_tag<T>(scts::host_is_little_endian));
+	}
+}
+
+TEST_CASE("cbor_formatter supports all required types", "[cbor_formatter]") {
+	complete_object a{
+		"cool{string[with]specialcharacters,",
+		true,
+		255,
+		state::moving,
+		nullptr,
+		{15.0f, -1.0f / 3.0f},
+		{base_object{1.0, -124}, base_object{-35.23, 0}},
+		{75.0, 98.0},
+		{{"key1", true}, {"key2", false}},
+		std::nullopt,
+		std::make_unique<int>(12)
+	};
+	const auto serialized = scts::serialize<complete_object, scts::cbor_formatter>(a);
+	auto b = scts::deserialize<complete_object, scts::cbor_formatter>(serialized.get_in_stream());
+	REQUIRE(a == b);
+
+	derived_object c{ -124.1, 76, 0.15f, "hello" };
+	derived_object d;
+	scts::deserialize<derived_object, scts::cbor_formatter>(d, scts::serialize<derived_object, scts::cbor_formatter>(c).get_in_stream());
+	REQUIRE(c == d);
+
+	numeric_buffers e{ { 1.0f, 2.0f, -0.5f }, { 0.25, 4.0, 1e300 }, { -1, 1, 300, -32768 }, { state::idle, state::moving } };
+	numeric_buffers f;
+	scts::deserialize<numeric_buffers, scts::cbor_formatter>(f, scts::serialize<numeric_buffers, scts::cbor_formatter>(e).get_in_stream());
+	REQUIRE(e == f);
+}
+
+TEST_CASE("cbor_formatter uses definite lengths and the shortest heads", "[cbor_formatter]") {
+	const auto serialized = scts::serialize<base_object, scts::cbor_formatter>(base_object{ 0.5, 3 }).str();
+	const auto expected = bytes_of({ 0xba, 0, 0, 0, 2, 0x64 }) + "data" + bytes_of({ 0xfb, 0x3f, 0xe0, 0, 0, 0, 0, 0, 0, 0x67 }) + "integer" + bytes_of({ 3 });
+	REQUIRE(serialized == expected);
+
+	const auto negative = scts::serialize<base_object, scts::cbor_formatter>(base_object{ 0.5, -3 }).str();
+	REQUIRE(negative.back() == 0x22);
+	const auto wide = scts::serialize<base_object, scts::cbor_formatter>(base_object{ 0.5, -300 }).str();
+	REQUIRE(wide.substr(wide.size() - 3) == bytes_of({ 0x39, 0x01, 0x2b }));
+
+	mesh g{ { 1.0f, 2.0f, 3.0f }, {} };
+	const auto nested = scts::serialize<mesh, scts::cbor_formatter>(g).str();
+	REQUIRE(nested.find(bytes_of({ 0x66 }) + "origin" + bytes_of({ 0xa3, 0x61 }) + "x" + bytes_of({ 0xfa, 0x3f, 0x80, 0, 0 })) != std::string::npos);
+	REQUIRE(nested.substr(nested.size() - 10) == bytes_of({ 0x68 }) + "vertices" + bytes_of({ 0x80 }));
+}
+
+TEST_CASE("cbor_formatter writes numbers as typed arrays", "[cbor_formatter]") {
+	numeric_buffers a{ { 1.0f, 2.0f }, { 0.25, 4.0, 8.0 }, { -1, 1, 300, 0 }, { state::idle, state::moving } };
+	const auto serialized = scts::serialize<numeric_buffers, scts::cbor_formatter>(a).str();
+
+	REQUIRE(scts::cbor_type::typed_array_tag<float>(true) == 85);
+	REQUIRE(scts::cbor_type::typed_array_tag<double>(false) == 82);
+	REQUIRE(scts::cbor_type::typed_array_tag<std::int16_t>(true) == 77);
+	REQUIRE(scts::cbor_type::typed_array_tag<std::uint8_t>(true) == 64);
+
+	const auto samples = std::string(1, static_cast<char>(0xd8)) + host_tag<float>() + bytes_of({ 0x48 })
+		+ std::string(reinterpret_cast<const char*>(a.samples.data()), 8);
+	REQUIRE(serialized.find(bytes_of({ 0x67 }) + "samples" + samples) != std::string::npos);
+	const auto weights = std::string(1, static_cast<char>(0xd8)) + host_tag<double>() + bytes_of({ 0x58, 24 })
+		+ std::string(reinterpret_cast<const char*>(a.weights.data()), 24);
+	REQUIRE(serialized.find(bytes_of({ 0x67 }) + "weights" + weights) != std::string::npos);
+	const auto offsets = std::string(1, static_cast<char>(0xd8)) + host_tag<std::int16_t>() + bytes_of({ 0x48 })
+		+ std::string(reinterpret_cast<const char*>(a.offsets), 8);
+	REQUIRE(serialized.find(bytes_of({ 0x67 }) + "offsets" + offsets) != std::string::npos);
+	REQUIRE(serialized.substr(serialized.size() - 10) == bytes_of({ 0x66 }) + "states" + bytes_of({ 0x82, 0, 1 }));
+}
+
+TEST_CASE("cbor_formatter writes null for missing values", "[cbor_formatter]") {
+	complete_object a{ "", false, 0, state::idle, nullptr, {}, {}, {}, {}, std::nullopt, nullptr };
+	const auto serialized = scts::serialize<complete_object, scts::cbor_formatter>(a).str();
+	REQUIRE(serialized.find(bytes_of({ 0x67 }) + "pointer" + bytes_of({ 0xf6 })) != std::string::npos);
+	REQUIRE(serialized.find(bytes_of({ 0x70 }) + "optional_of_enum" + bytes_of({ 0xf6 })) != std::string::npos);
+	REQUIRE(serialized.substr(serialized.size() - 11) == bytes_of({ 0x69 }) + "smart_ptr" + bytes_of({ 0xf6 }));
+
+	complete_object b{ "", false, 0, state::idle, nullptr, {}, {}, {}, {}, state::moving, std::make_unique<int>(1) };
+	scts::deserialize<complete_object, scts::cbor_formatter>(b, serialized);
+	REQUIRE(!b.optional_of_enum.has_value());
+	REQUIRE(b.smart_ptr == nullptr);
+}
+
+TEST_CASE("cbor_formatter reads input from other encoders", "[cbor_formatter]") {
+	// An indefinite length map with an unknown key holding tagged and nested values, a half precision float,
+	// a big endian typed array, a plain array of numbers and an indefinite length array.
+	const auto input = bytes_of({ 0xbf, 0x67 }) + "unknown" + bytes_of({ 0x82, 0xc1, 0x1a, 0, 0, 0, 1, 0x9f, 0x5f, 0x41, 0, 0xff, 0xff })
+		+ bytes_of({ 0x67 }) + "samples" + bytes_of({ 0xd8, 81, 0x48, 0x3f, 0x80, 0, 0, 0xc0, 0, 0, 0 })
+		+ bytes_of({ 0x67 }) + "weights" + bytes_of({ 0x83, 0xf9, 0x3c, 0x00, 0x02, 0x21 })
+		+ bytes_of({ 0x67 }) + "offsets" + bytes_of({ 0x9f, 0x01, 0x20, 0x19, 0x01, 0x2c, 0x00, 0xff })
+		+ bytes_of({ 0x66 }) + "states" + bytes_of({ 0x81, 0x01, 0xff });
+	numeric_buffers a{};
+	scts::deserialize<numeric_buffers, scts::cbor_formatter>(a, input);
+	const numeric_buffers expected{ { 1.0f, -2.0f }, { 1.0, 2.0, -2.0 }, { 1, -1, 300, 0 }, { state::moving } };
+	REQUIRE(a == expected);
+}
+
+TEST_CASE("cbor_formatter rejects invalid input", "[cbor_formatter]") {
+	base_object a{};
+	const auto too_large = bytes_of({ 0xa1, 0x67 }) + "integer" + bytes_of({ 0x1b, 1, 0, 0, 0, 0, 0, 0, 0 });
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::cbor_formatter>(a, too_large)), scts::invalid_cbor);
+	const auto not_a_map = bytes_of({ 0x81, 1 });
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::cbor_formatter>(a, not_a_map)), scts::invalid_cbor);
+	const auto wrong_type = bytes_of({ 0xa1, 0x64 }) + "data" + bytes_of({ 0x61 }) + "x";
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::cbor_formatter>(a, wrong_type)), scts::invalid_cbor);
+	const auto truncated = bytes_of({ 0xa1, 0x64 }) + "data" + bytes_of({ 0xfb, 0x3f });
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::cbor_formatter>(a, truncated)), scts::unexpected_end_of_stream);
+
+	numeric_buffers b{};
+	const auto wrong_element = bytes_of({ 0xa1, 0x67 }) + "samples" + bytes_of({ 0xd8, 86, 0x48, 0, 0, 0, 0, 0, 0, 0, 0 });
+	REQUIRE_THROWS_AS((scts::deserialize<numeric_buffers, scts::cbor_formatter>(b, wrong_element)), scts::invalid_cbor);
+	const auto wrong_size = bytes_of({ 0xa1, 0x67 }) + "weights" + bytes_of({ 0x82, 0xf9, 0x3c, 0x00, 0x00 });
+	REQUIRE_THROWS_AS((scts::deserialize<numeric_buffers, scts::cbor_formatter>(b, wrong_size)), scts::invalid_cbor);
+}
@@ -0,0 +1,113 @@
+#include "catch.hpp"
+
+#include "test_objects.h"
+
+#include <string>
+#include <cstdint>
+
+namespace {
+	batch repetitive_batch(std::size_t count) {
+		batch records;
+		for (std::size_t i = 0; i < count; ++i) {
+			records.records.push_back(derived_object{ 1.5, static_cast<int>(i % 4), 0.25f, "an entity in the world" });
+		}
+		return records;
+	}
+
+	std::string pseudo_random_bytes(std::size_t count) {
+		std::string bytes(count, '\0');
+		std::uint32_t state = 12345;
+		for (auto& byte : bytes) {
+			state = state * 1664525u + 1013904223u;
+			byte = static_cast<char>(state >> 24);
+		}
+		return bytes;
+	}
+}
+
+TEST_CASE("compressed json serialization and deserialization", "[compressed_formatter]") {
+	const auto a = repetitive_batch(1000);
+	const auto plain = scts::serialize(a);
+	const auto compressed = scts::serialize<batch, scts::compressed<scts::json_formatter>>(a);
+	batch b;
+	scts::deserialize<batch, scts::compressed<scts::json_formatter>>(b, compressed.get_in_stream());
+
+	REQUIRE(a == b);
+	REQUIRE(compressed.size() * 10 < plain.size());
+}
+
+TEST_CASE("compressed binary serialization and deserialization", "[compressed_formatter]") {
+	derived_object a{ -124.1, 76, 0.15f, "hello hello hello hello hello" };
+	const auto compressed = scts::serialize<derived_object, scts::compressed<scts::binary_formatter>>(a);
+	derived_object b;
+	scts::deserialize<derived_object, scts::compressed<scts::binary_formatter>>(b, compressed.get_in_stream());
+
+	REQUIRE(a == b);
+}
+
+TEST_CASE("compression works in blocks", "[compressed_formatter]") {
+	const auto a = repetitive_batch(100);
+	const scts::compressed<scts::json_formatter> formatter{ scts::json_formatter(), 256 };
+	const auto compressed = scts::serialize(a, formatter);
+	batch b;
+	scts::deserialize(b, compressed.get_in_stream(), formatter);
+
+	REQUIRE(a == b);
+	// Blocks are independent, so the decompressing formatter does not need to know the block size.
+	batch c;
+	scts::deserialize<batch, scts::compressed<scts::json_formatter>>(c, compressed.get_in_stream());
+	REQUIRE(a == c);
+}
+
+TEST_CASE("incompressible blocks are stored as they are", "[compressed_formatter]") {
+	derived_object a{ 0.0, 0, 0.0f, pseudo_random_bytes(100000) };
+	const auto plain = scts::serialize<derived_object, scts::binary_formatter>(a);
+	const auto compressed = scts::serialize<derived_object, scts::compressed<scts::binary_formatter>>(a);
+	derived_object b;
+	scts::deserialize<derived_object, scts::compressed<scts::binary_formatter>>(b, compressed.get_in_stream());
+
+	REQUIRE(a == b);
+	// The block size, two block headers and the end of the frame.
+	REQUIRE(compressed.size() <= plain.size() + 4 * 4);
+}
+
+TEST_CASE("compression keeps what precedes the output in the stream", "[compressed_formatter]") {
+	base_object a{ 0.35, 12 };
+	scts::out_stream stream;
+	stream << "prefix";
+	scts::serialize<base_object, scts::compressed<scts::json_formatter>>(a, stream);
+
+	REQUIRE(stream.view().substr(0, 6) == "prefix");
+	base_object b;
+	scts::deserialize<base_object, scts::compressed<scts::json_formatter>>(b, stream.view().substr(6));
+	REQUIRE(a == b);
+}
+
+TEST_CASE("lz_codec round trips overlapping matches", "[compressed_formatter]") {
+	const std::string input = std::string(1000, 'a') + "abcabcabcabcabcabc" + pseudo_random_bytes(50) + std::string(300, 'b');
+	std::string output(input.size(), '\0');
+	std::vector<std::uint32_t> table(scts::lz_codec::hash_table_size);
+	const auto size = scts::lz_codec::compress(input.data(), input.size(), output.data(), output.size(), table.data());
+	REQUIRE(size > 0);
+	REQUIRE(size < 100);
+
+	std::string decompressed(input.size(), '\0');
+	REQUIRE(scts::lz_codec::decompress(std::string_view(output.data(), size), decompressed.data(), decompressed.size()) == input.size());
+	REQUIRE(decompressed == input);
+}
+
+TEST_CASE("invalid compressed data is rejected", "[compressed_formatter]") {
+	base_object a{ 0.35, 12 };
+	auto compressed = scts::serialize<base_object, scts::compressed<scts::json_formatter>>(a).str();
+	base_object b;
+
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::compressed<scts::json_formatter>>(b, compressed.substr(0, compressed.size() - 2))), scts::unexpected_end_of_stream);
+
+	// A match reaching back before the start of the block.
+	const std::string bad_match("\x10" "a" "\x05\x00", 4);
+	char output[16];
+	REQUIRE_THROWS_AS(scts::lz_codec::decompress(bad_match, output, sizeof(output)), scts::invalid_compressed_data);
+	// More output than the block can hold.
+	const std::string too_long("\x1f" "a" "\x01\x00" "\x40", 5);
+	REQUIRE_THROWS_AS(scts::lz_codec::decompress(too_long, output, sizeof(output)), scts::invalid_compressed_data);
+}
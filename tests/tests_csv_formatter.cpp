@@ -0,0 +1,166 @@
+#include "catch.hpp"
+
+#include "test_objects.h"
+#include "test_helpers.h"
+
+#include <string>
+#include <vector>
+#include <optional>
+
+namespace {
+	struct trade {
+		std::string symbol;
+		std::int64_t quantity;
+		double price;
+		bool settled;
+		state side;
+		std::optional<std::string> note;
+		std::optional<int> venue;
+
+		bool operator==(const trade& other) const {
+			return symbol == other.symbol && quantity == other.quantity && price == other.price && settled == other.settled &&
+				side == other.side && note == other.note && venue == other.venue;
+		}
+	};
+
+	std::string read_all(int descriptor) {
+		std::string bytes;
+		char chunk[256];
+		for (std::size_t read; (read = scts::descriptor_io::read_some(descriptor, chunk, sizeof(chunk))) > 0;) bytes.append(chunk, read);
+		return bytes;
+	}
+}
+
+template <> struct scts::register_type<trade> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<trade,
+		scts::members<
+		scts::member<&trade::symbol>,
+		scts::member<&trade::quantity>,
+		scts::member<&trade::price>,
+		scts::member<&trade::settled>,
+		scts::member<&trade::side>,
+		scts::member<&trade::note>,
+		scts::member<&trade::venue>>> descriptor{ "symbol", "quantity", "price", "settled", "side", "note", "venue" };
+};
+
+TEST_CASE("csv writes a header and one row per object", "[csv_formatter]") {
+	scts::out_stream stream;
+	{
+		scts::csv_writer<derived_object> writer(stream);
+		writer.write(derived_object{ 1.5, 2, 0.25f, "first" });
+		writer.write(derived_object{ -3, 4, 8, "second" });
+	}
+	REQUIRE(stream.str() == "data,integer,floating,string\n1.5,2,0.25,first\n-3,4,8,second\n");
+
+	scts::csv_reader<derived_object> reader(stream.view());
+	derived_object object;
+	REQUIRE(reader.read(object));
+	REQUIRE(object == derived_object{ 1.5, 2, 0.25f, "first" });
+	REQUIRE(reader.read(object));
+	REQUIRE(object == derived_object{ -3, 4, 8, "second" });
+	REQUIRE_FALSE(reader.read(object));
+}
+
+TEST_CASE("csv writes the header even without rows", "[csv_formatter]") {
+	scts::out_stream stream;
+	{
+		scts::csv_writer<derived_object> writer(stream);
+	}
+	REQUIRE(stream.str() == "data,integer,floating,string\n");
+
+	scts::csv_reader<derived_object> reader(stream.view());
+	derived_object object;
+	REQUIRE_FALSE(reader.read(object));
+
+	test_pipe channel;
+	{
+		scts::csv_writer<base_object> writer(channel.writing());
+	}
+	channel.close_writing();
+	REQUIRE(read_all(channel.reading()) == "data,integer\n");
+}
+
+TEST_CASE("csv quotes fields that need it", "[csv_formatter]") {
+	const std::vector<trade> trades{
+		{ "plain", 1, 0.5, true, state::moving, std::nullopt, 3 },
+		{ "with, comma", -2, 1e300, false, state::idle, std::string(), std::nullopt },
+		{ "say \"hi\"", 0, -0.125, true, state::idle, std::string("two\nlines\r\n"), 0 },
+	};
+	scts::out_stream stream;
+	scts::csv_writer<trade> writer(stream);
+	for (const auto& t : trades) writer.write(t);
+	REQUIRE(stream.str() ==
+		"symbol,quantity,price,settled,side,note,venue\n"
+		"plain,1,0.5,true,1,,3\n"
+		"\"with, comma\",-2,1e+300,false,0,\"\",\n"
+		"\"say \"\"hi\"\"\",0,-0.125,true,0,\"two\nlines\r\n\",0\n");
+
+	scts::csv_reader<trade> reader(stream.view());
+	trade object;
+	for (const auto& expected : trades) {
+		REQUIRE(reader.read(object));
+		REQUIRE(object == expected);
+	}
+	REQUIRE_FALSE(reader.read(object));
+}
+
+TEST_CASE("tsv uses tabs as the delimiter", "[csv_formatter]") {
+	scts::out_stream stream;
+	scts::csv_writer<base_object> writer(stream, scts::csv_formatter(scts::csv_formatter::tab));
+	writer.write(base_object{ 0.5, 1 });
+	writer.write(base_object{ 2, 3 });
+	REQUIRE(stream.str() == "data\tinteger\n0.5\t1\n2\t3\n");
+
+	scts::csv_reader<base_object> reader(scts::in_stream("integer\tdata\r\n1\t0.5\r\n3\t2"), scts::csv_formatter(scts::csv_formatter::tab));
+	base_object object;
+	REQUIRE(reader.read(object));
+	REQUIRE(object == base_object{ 0.5, 1 });
+	REQUIRE(reader.read(object));
+	REQUIRE(object == base_object{ 2, 3 });
+	REQUIRE_FALSE(reader.read(object));
+}
+
+TEST_CASE("csv columns are matched to members by the header", "[csv_formatter]") {
+	scts::csv_reader<derived_object> reader(scts::in_stream("string,unknown,integer,data\n\"a,b\",\"x\"\"y\",7,0.5\nc,,8,1\n"));
+	derived_object object{ 0, 0, 9.0f, "" };
+	REQUIRE(reader.read(object));
+	REQUIRE(object == derived_object{ 0.5, 7, 9.0f, "a,b" });
+	REQUIRE(reader.read(object));
+	REQUIRE(object == derived_object{ 1, 8, 9.0f, "c" });
+	REQUIRE_FALSE(reader.read(object));
+}
+
+TEST_CASE("csv rows can be written to a file descriptor", "[csv_formatter]") {
+	test_pipe channel;
+	{
+		scts::csv_writer<base_object> writer(channel.writing());
+		writer.write(base_object{ 1, 2 });
+		writer.write(base_object{ 3, 4 });
+	}
+	channel.close_writing();
+	REQUIRE(read_all(channel.reading()) == "data,integer\n1,2\n3,4\n");
+}
+
+TEST_CASE("malformed csv throws", "[csv_formatter]") {
+	base_object object;
+	SECTION("missing fields") {
+		scts::csv_reader<base_object> reader(scts::in_stream("data,integer\n1\n"));
+		REQUIRE_THROWS_AS(reader.read(object), scts::invalid_csv);
+	}
+	SECTION("extra fields") {
+		scts::csv_reader<base_object> reader(scts::in_stream("data,integer\n1,2,3\n"));
+		REQUIRE_THROWS_AS(reader.read(object), scts::invalid_csv);
+	}
+	SECTION("unterminated quotes") {
+		scts::csv_reader<base_object> reader(scts::in_stream("data,integer\n\"1,2\n"));
+		REQUIRE_THROWS_AS(reader.read(object), scts::invalid_csv);
+	}
+	SECTION("text after closing quotes") {
+		scts::csv_reader<base_object> reader(scts::in_stream("data,integer\n\"1\"x,2\n"));
+		REQUIRE_THROWS_AS(reader.read(object), scts::invalid_csv);
+	}
+	SECTION("invalid numbers") {
+		scts::csv_reader<base_object> reader(scts::in_stream("data,integer\n1,two\n"));
+		REQUIRE_THROWS_AS(reader.read(object), scts::invalid_lexical_cast);
+	}
+}
@@ -0,0 +1,157 @@
+#include "catch.hpp"
+
+#include "test_objects.h"
+
+TEST_CASE("an unchanged object gives an empty delta", "[delta]") {
+	derived_object a{ -124.1, 76, 0.15f, "hello" };
+
+	REQUIRE(scts::serialize_delta(a, a).str() == "{}");
+	// Only the fingerprint and a bitmap with a bit for each of the four members.
+	REQUIRE(scts::serialize_delta<derived_object, scts::binary_formatter>(a, a).str().size() == 8 + 1);
+}
+
+TEST_CASE("json deltas only hold the changed members", "[delta]") {
+	derived_object previous{ -124.1, 76, 0.15f, "hello" };
+	derived_object current = previous;
+	current.integer = 77;
+	current.string = "world";
+
+	auto stream = scts::serialize_delta(previous, current);
+	REQUIRE(stream.str() == R"({"integer":77,"string":"world"})");
+
+	scts::apply_delta(previous, stream.get_in_stream());
+	REQUIRE(previous == current);
+}
+
+TEST_CASE("json deltas recurse into nested objects", "[delta]") {
+	mesh previous{ { 1.0f, 2.0f, 3.0f }, { { 0.5f, 0.5f, 0.5f } } };
+	mesh current = previous;
+	current.origin.y = 4.0f;
+
+	auto stream = scts::serialize_delta(previous, current);
+	REQUIRE(stream.str() == R"({"origin":{"y":4}})");
+
+	scts::apply_delta(previous, stream.get_in_stream());
+	REQUIRE(previous == current);
+}
+
+TEST_CASE("json deltas recurse into sequences of objects that kept their length", "[delta]") {
+	mesh previous{ { 1.0f, 2.0f, 3.0f }, { { 0.5f, 0.5f, 0.5f }, { 1.5f, 1.5f, 1.5f }, { 2.5f, 2.5f, 2.5f } } };
+	mesh current = previous;
+	current.vertices[0].y = -1.0f;
+	current.vertices[2].x = 7.0f;
+
+	auto stream = scts::serialize_delta(previous, current);
+	REQUIRE(stream.str() == R"({"vertices":{"0":{"y":-1},"2":{"x":7}}})");
+
+	scts::apply_delta(previous, stream.get_in_stream());
+	REQUIRE(previous == current);
+
+	// Sequences that changed length are written whole.
+	current.vertices.pop_back();
+	auto shorter = scts::serialize_delta(previous, current);
+	REQUIRE(shorter.str() == R"({"vertices":[{"x":0.5,"y":-1,"z":0.5},{"x":1.5,"y":1.5,"z":1.5}]})");
+
+	scts::apply_delta(previous, shorter.get_in_stream());
+	REQUIRE(previous == current);
+}
+
+TEST_CASE("json deltas of sequences reject elements out of range", "[delta]") {
+	mesh object{ { 1.0f, 2.0f, 3.0f }, { { 0.5f, 0.5f, 0.5f } } };
+	REQUIRE_THROWS_AS(scts::apply_delta(object, scts::in_stream(R"({"vertices":{"1":{"x":7}}})")), scts::invalid_json);
+}
+
+TEST_CASE("binary deltas only hold the changed members", "[delta]") {
+	derived_object previous{ -124.1, 76, 0.15f, "hello" };
+	derived_object current = previous;
+	current.integer = 77;
+
+	auto stream = scts::serialize_delta<derived_object, scts::binary_formatter>(previous, current);
+	REQUIRE(stream.str().size() == 8 + 1 + sizeof(current.integer));
+
+	scts::apply_delta<derived_object, scts::binary_formatter>(previous, stream.get_in_stream());
+	REQUIRE(previous == current);
+}
+
+TEST_CASE("binary deltas recurse into nested objects and vectors of objects", "[delta]") {
+	mesh previous{ { 1.0f, 2.0f, 3.0f }, { { 0.5f, 0.5f, 0.5f }, { 1.5f, 1.5f, 1.5f }, { 2.5f, 2.5f, 2.5f } } };
+	mesh current = previous;
+	current.origin.z = -3.0f;
+	current.vertices[2].x = 7.0f;
+
+	auto stream = scts::serialize_delta<mesh, scts::compact_binary_formatter>(previous, current);
+	// The fingerprint, the member bitmaps of the mesh and its origin, the new z, the same length flag, the element bitmap,
+	// and the member bitmap and new x of the third vertex.
+	REQUIRE(stream.str().size() == 8 + 1 + 1 + sizeof(float) + 1 + 1 + 1 + sizeof(float));
+
+	scts::apply_delta<mesh, scts::compact_binary_formatter>(previous, stream.get_in_stream());
+	REQUIRE(previous == current);
+}
+
+TEST_CASE("binary deltas of vectors that changed length hold the whole vector", "[delta]") {
+	batch previous{ { derived_object{ 1.0, 2, 3.0f, "four" } } };
+	batch current = previous;
+	current.records.push_back(derived_object{ 5.0, 6, 7.0f, "eight" });
+
+	auto stream = scts::serialize_delta<batch, scts::portable_binary_formatter>(previous, current);
+	scts::apply_delta<batch, scts::portable_binary_formatter>(previous, stream.get_in_stream());
+	REQUIRE(previous == current);
+}
+
+TEST_CASE("deltas cover all required types", "[delta]") {
+	complete_object previous{
+		"string", true, 255, state::moving, nullptr, {15.0f, 1.0f}, {base_object{1.0, -124}, base_object{-35.23, 0}},
+		{75.0, 98.0}, {{"key1", true}}, std::nullopt, std::make_unique<int>(12)
+	};
+	complete_object current{
+		"string", false, 255, state::moving, nullptr, {15.0f, 2.0f}, {base_object{1.0, -124}, base_object{-35.23, 1}},
+		{75.0, 98.0}, {{"key1", true}, {"key2", false}}, state::idle, std::make_unique<int>(13)
+	};
+
+	complete_object binary_previous{
+		"string", true, 255, state::moving, nullptr, {15.0f, 1.0f}, {base_object{1.0, -124}, base_object{-35.23, 0}},
+		{75.0, 98.0}, {{"key1", true}}, std::nullopt, std::make_unique<int>(12)
+	};
+	auto binary_stream = scts::serialize_delta<complete_object, scts::binary_formatter>(previous, current);
+	scts::apply_delta<complete_object, scts::binary_formatter>(binary_previous, binary_stream.get_in_stream());
+	REQUIRE(scts::values_equal(binary_previous, current));
+
+	auto json_stream = scts::serialize_delta(previous, current);
+	scts::apply_delta(previous, json_stream.get_in_stream());
+	REQUIRE(scts::values_equal(previous, current));
+}
+
+TEST_CASE("deltas read changed pointees over the ones the object points to", "[delta]") {
+	base_object previous_pointee{ 1.0, 2 };
+	base_object current_pointee{ 1.0, 3 };
+	complete_object previous{
+		"string", true, 255, state::moving, &previous_pointee, {15.0f, 1.0f}, {}, {75.0, 98.0}, {}, std::nullopt, std::make_unique<int>(12)
+	};
+	complete_object current{
+		"string", true, 255, state::moving, &current_pointee, {15.0f, 1.0f}, {}, {75.0, 98.0}, {}, std::nullopt, std::make_unique<int>(12)
+	};
+
+	base_object binary_pointee = previous_pointee;
+	complete_object binary_object{
+		"string", true, 255, state::moving, &binary_pointee, {15.0f, 1.0f}, {}, {75.0, 98.0}, {}, std::nullopt, std::make_unique<int>(12)
+	};
+	auto binary_stream = scts::serialize_delta<complete_object, scts::binary_formatter>(previous, current);
+	scts::apply_delta<complete_object, scts::binary_formatter>(binary_object, binary_stream.get_in_stream());
+	REQUIRE(binary_object.pointer == &binary_pointee);
+	REQUIRE(binary_pointee == current_pointee);
+
+	auto json_stream = scts::serialize_delta(previous, current);
+	REQUIRE(json_stream.str() == R"({"pointer":{"data":1,"integer":3}})");
+	scts::apply_delta(previous, json_stream.get_in_stream());
+	REQUIRE(previous.pointer == &previous_pointee);
+	REQUIRE(previous_pointee == current_pointee);
+}
+
+TEST_CASE("deltas cannot be read as whole objects", "[delta]") {
+	base_object previous{ 0.35, 12 };
+	base_object current{ 0.35, 13 };
+
+	auto stream = scts::serialize_delta<base_object, scts::binary_formatter>(previous, current);
+	base_object object;
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::binary_formatter>(object, stream.get_in_stream())), scts::schema_mismatch);
+}
@@ -0,0 +1,108 @@
+#include "catch.hpp"
+
+#include "test_objects.h"
+
+TEST_CASE("flat serialization and deserialization", "[flat_formatter]") {
+	complete_object a{
+		"cool{string[with]specialcharacters,",
+		true,
+		255,
+		state::moving,
+		new base_object{ 2.5, 3 },
+		{15.0f, -1.0f / 3.0f},
+		{base_object{1.0, -124}, base_object{-35.23, 0}},
+		{75.0, 98.0},
+		{{"key1", true}, {"key2", false}},
+		std::nullopt,
+		std::make_unique<int>(12)
+	};
+	auto serialized = scts::serialize<complete_object, scts::flat_formatter>(a);
+	complete_object b{};
+	scts::deserialize<complete_object, scts::flat_formatter>(b, serialized.get_in_stream());
+
+	REQUIRE(*b.pointer == *a.pointer);
+	delete a.pointer;
+	delete b.pointer;
+	a.pointer = b.pointer = nullptr;
+	REQUIRE(a == b);
+}
+
+TEST_CASE("flat inheritance", "[flat_formatter]") {
+	derived_object a{ -124.1, 76, 0.15f, "hello" };
+	auto serialized = scts::serialize<derived_object, scts::flat_formatter>(a);
+	derived_object b;
+	scts::deserialize<derived_object, scts::flat_formatter>(b, serialized.get_in_stream());
+	REQUIRE(a == b);
+
+	scts::flat_view<derived_object> view(serialized.view());
+	REQUIRE(view.get<&derived_object::data>() == -124.1);
+	REQUIRE(view.get<&derived_object::integer>() == 76);
+	REQUIRE(view.get<&derived_object::floating>() == 0.15f);
+	REQUIRE(view.get<&derived_object::string>() == "hello");
+}
+
+TEST_CASE("flat_view reads members in place", "[flat_formatter]") {
+	complete_object a{
+		"viewed",
+		true,
+		7,
+		state::moving,
+		nullptr,
+		{1.0f, 2.0f},
+		{base_object{1.0, -124}, base_object{-35.23, 0}},
+		{75.0, 98.0},
+		{{"b", false}, {"a", true}, {"c", true}},
+		state::idle,
+		std::make_unique<int>(-5)
+	};
+	auto serialized = scts::serialize<complete_object, scts::flat_formatter>(a);
+	scts::flat_view<complete_object> view(serialized.view());
+
+	const std::string_view string = view.get<&complete_object::string>();
+	REQUIRE(string == "viewed");
+	// Strings are not copied out of the buffer.
+	REQUIRE(string.data() > serialized.data());
+	REQUIRE(string.data() < serialized.data() + serialized.size());
+
+	REQUIRE(view.get<&complete_object::boolean>());
+	REQUIRE(view.get<&complete_object::byte>() == 7);
+	REQUIRE(view.get<&complete_object::enumeration>() == state::moving);
+	REQUIRE_FALSE(view.get<&complete_object::pointer>().has_value());
+	REQUIRE(view.get<&complete_object::optional_of_enum>() == state::idle);
+	REQUIRE(view.get<&complete_object::smart_ptr>() == -5);
+
+	const auto c_array = view.get<&complete_object::c_array>();
+	REQUIRE(c_array.size() == 2);
+	REQUIRE(c_array[1] == 2.0f);
+
+	const auto objects = view.get<&complete_object::vector_of_objects>();
+	REQUIRE(objects.size() == 2);
+	REQUIRE(objects[0].get<&base_object::integer>() == -124);
+	std::vector<double> data;
+	for (const auto object : objects) data.push_back(object.get<&base_object::data>());
+	REQUIRE(data == std::vector<double>{ 1.0, -35.23 });
+
+	const auto map = view.get<&complete_object::map_of_booleans>();
+	REQUIRE(map.size() == 3);
+	REQUIRE(map.key(0) == "a");
+	REQUIRE(map.find("b") == false);
+	REQUIRE(map.find("c") == true);
+	REQUIRE_FALSE(map.find("d").has_value());
+}
+
+TEST_CASE("flat layout rejects mismatching and malformed input", "[flat_formatter]") {
+	base_object a{ 1.5, 2 };
+	auto serialized = scts::serialize<base_object, scts::flat_formatter>(a);
+	REQUIRE_THROWS_AS(scts::flat_view<derived_object>(serialized.view()), scts::schema_mismatch);
+	REQUIRE_THROWS_AS(scts::flat_view<base_object>(serialized.view().substr(0, serialized.size() - 1)), scts::unexpected_end_of_stream);
+
+	// A member pointing to its own slot.
+	auto cyclic = serialized.str();
+	std::uint32_t root;
+	std::memcpy(&root, cyclic.data(), sizeof(root));
+	root = scts::to_little_endian(root);
+	const auto slot = scts::to_little_endian(root + 4);
+	std::memcpy(&cyclic[root + 4], &slot, sizeof(slot));
+	scts::flat_view<base_object> view(cyclic);
+	REQUIRE_THROWS_AS(view.get<&base_object::data>(), scts::invalid_flat_layout);
+}
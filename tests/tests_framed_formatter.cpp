@@ -0,0 +1,73 @@
+#include "catch.hpp"
+
+#include "test_objects.h"
+
+#include <string>
+#include <cstdint>
+
+using framed_binary = scts::framed<scts::binary_formatter>;
+
+TEST_CASE("crc32c matches the reference check value", "[framed_formatter]") {
+	const std::string check = "123456789";
+	REQUIRE(scts::crc32c::compute(check) == 0xe3069283u);
+	REQUIRE(scts::crc32c::update_software(0, check.data(), check.size()) == 0xe3069283u);
+	REQUIRE(scts::crc32c::compute("") == 0);
+}
+
+TEST_CASE("crc32c gives the same result however the data is split", "[framed_formatter]") {
+	std::string data(1000, '\0');
+	for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<char>(i * 7 + i / 13);
+
+	for (std::size_t size : { 0, 1, 7, 8, 9, 63, 1000 }) {
+		const auto whole = scts::crc32c::update_software(0, data.data(), size);
+		REQUIRE(scts::crc32c::update(0, data.data(), size) == whole);
+		const auto split = size / 3;
+		REQUIRE(scts::crc32c::update(scts::crc32c::update(0, data.data(), split), data.data() + split, size - split) == whole);
+	}
+}
+
+TEST_CASE("framed serialization and deserialization", "[framed_formatter]") {
+	derived_object a{ -124.1, 76, 0.15f, "hello" };
+	const auto frame = scts::serialize<derived_object, framed_binary>(a);
+	derived_object b;
+	scts::deserialize<derived_object, framed_binary>(b, frame.get_in_stream());
+	REQUIRE(a == b);
+
+	numeric_buffers c{ { 1.0f, 2.0f }, { 0.5 }, { -1, 1 }, { state::idle, state::moving } };
+	const auto compact_frame = scts::serialize<numeric_buffers, scts::framed<scts::compact_binary_formatter>>(c);
+	numeric_buffers d;
+	scts::deserialize<numeric_buffers, scts::framed<scts::compact_binary_formatter>>(d, compact_frame.get_in_stream());
+	REQUIRE(c == d);
+}
+
+TEST_CASE("frames hold the payload between a header and a checksum", "[framed_formatter]") {
+	base_object a{ 0.35, 12 };
+	const auto frame = scts::serialize<base_object, framed_binary>(a).str();
+	const auto payload = scts::serialize<base_object, scts::binary_formatter>(a).str().substr(sizeof(std::uint64_t));
+
+	REQUIRE(frame.size() == scts::frame_layout::header_size + payload.size() + scts::frame_layout::trailer_size);
+	REQUIRE(scts::frame_layout::frame_size(frame) == frame.size());
+	REQUIRE(scts::frame_layout::load<std::uint32_t>(frame.data()) == payload.size());
+	REQUIRE(frame[4] == framed_binary::format);
+	REQUIRE(frame[5] == scts::frame_layout::version);
+	REQUIRE(scts::frame_layout::load<std::uint64_t>(frame.data() + 6) == scts::register_type<base_object>::descriptor.fingerprint());
+	REQUIRE(frame.substr(scts::frame_layout::header_size, payload.size()) == payload);
+	const auto checked = std::string_view(frame).substr(4, frame.size() - 8);
+	REQUIRE(scts::frame_layout::load<std::uint32_t>(frame.data() + frame.size() - 4) == scts::crc32c::compute(checked));
+}
+
+TEST_CASE("damaged frames are rejected", "[framed_formatter]") {
+	derived_object a{ -124.1, 76, 0.15f, "hello" };
+	const auto frame = scts::serialize<derived_object, framed_binary>(a).str();
+	derived_object b;
+
+	auto corrupted = frame;
+	corrupted[scts::frame_layout::header_size + 3] ^= 0x10;
+	REQUIRE_THROWS_AS((scts::deserialize<derived_object, framed_binary>(b, corrupted)), scts::checksum_mismatch);
+
+	REQUIRE_THROWS_AS((scts::deserialize<derived_object, framed_binary>(b, frame.substr(0, frame.size() - 1))), scts::unexpected_end_of_stream);
+	REQUIRE_THROWS_AS((scts::deserialize<derived_object, scts::framed<scts::compact_binary_formatter>>(b, frame)), scts::invalid_frame);
+
+	base_object c;
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, framed_binary>(c, frame)), scts::schema_mismatch);
+}
@@ -67,4 +67,100 @@ TEST_CASE("json_formatter supports all required types", "[json_formatter]") {
 	auto serialized = scts::serialize(a);
 	auto b = scts::deserialize<complete_object>(serialized.get_in_stream());
 	REQUIRE(a == b);
-}
\ No newline at end of file
+}
+
+TEST_CASE("deserializing from views of the input", "[json_formatter]") {
+	const base_object expected{ 0.5, 3 };
+	const auto serialized = scts::serialize(expected);
+
+	SECTION("string_view") {
+		const std::string_view view = serialized.view();
+		REQUIRE(scts::deserialize<base_object>(view) == expected);
+	}
+
+	SECTION("bytes") {
+		const auto bytes = reinterpret_cast<const std::byte*>(serialized.data());
+		REQUIRE(scts::deserialize<base_object>(scts::in_stream(bytes, serialized.size())) == expected);
+#if SCTS_HAS_SPAN
+		REQUIRE(scts::deserialize<base_object>(std::span<const std::byte>(bytes, serialized.size())) == expected);
+#endif
+	}
+}
+
+TEST_CASE("unknown keys are skipped", "[json_formatter]") {
+	const auto in_stream = R"({
+		"unknown_object": { "data": 5, "list": [1, {"a": "}"}] },
+		"string": "known",
+		"unknown_list": [ [], [1, 2] ],
+		"integer": 7,
+		"unknown_number": -1.5e3
+	})";
+	derived_object a{ 1.0, 0, 2.0f, "" };
+	scts::deserialize(a, in_stream);
+	derived_object expected{ 1.0, 7, 2.0f, "known" };
+
+	REQUIRE(a == expected);
+}
+
+TEST_CASE("invalid json is rejected", "[json_formatter]") {
+	base_object a{};
+	REQUIRE_THROWS_AS(scts::deserialize(a, R"({"data" 1})"), scts::invalid_json);
+	REQUIRE_THROWS_AS(scts::deserialize(a, R"({"data": 1)"), scts::invalid_json);
+}
+
+TEST_CASE("structural index", "[json_formatter]") {
+	std::string json = R"({"a": [1, 2, {"b": "x,{y}:[z]"}], "c" : "", "d": {}})";
+	// Long enough to cover full chunks, a string crossing a chunk boundary and a partial last chunk.
+	for (int i = 0; i < 5; ++i) json += json;
+
+	scts::structural_index expected;
+	for (std::size_t i = 0, inside_string = 0; i < json.size(); ++i) {
+		const auto character = json[i];
+		if (character == '"') {
+			inside_string = !inside_string;
+			expected.push_back(static_cast<std::uint32_t>(i));
+		}
+		else if (!inside_string && std::string_view("{}[]:,").find(character) != std::string_view::npos) {
+			expected.push_back(static_cast<std::uint32_t>(i));
+		}
+	}
+
+	scts::structural_index index;
+	scts::json_indexer::build(json, index, scts::json_indexer::kernel::scalar);
+	REQUIRE(index == expected);
+
+	const auto& features = scts::cpu_features::get();
+	if (features.sse2) {
+		scts::json_indexer::build(json, index, scts::json_indexer::kernel::sse2);
+		REQUIRE(index == expected);
+	}
+	if (features.avx2) {
+		scts::json_indexer::build(json, index, scts::json_indexer::kernel::avx2);
+		REQUIRE(index == expected);
+	}
+}
+
+TEST_CASE("reading through the structural index", "[json_formatter]") {
+	complete_object a{
+		"cool{string[with]specialcharacters,",
+		false,
+		12,
+		state::idle,
+		nullptr,
+		{1.0f, 2.0f},
+		{base_object{1.0, -124}, base_object{-35.23, 0}},
+		{75.0, 98.0},
+		{{"key1", true}, {"key2", false}},
+		state::moving,
+		std::make_unique<int>(-5)
+	};
+	auto serialized = scts::serialize(a);
+	scts::json_formatter formatter{ scts::json_writer::compact, scts::json_reader::indexing::always };
+	auto b = scts::deserialize<complete_object>(serialized.get_in_stream(), formatter);
+	REQUIRE(a == b);
+
+	const auto in_stream = R"({ "unknown": {"x": [1, "]"]}, "integer" : 3 , "data": 1.5 })";
+	base_object c{};
+	scts::deserialize(c, in_stream, formatter);
+	REQUIRE(c == base_object{ 1.5, 3 });
+}
@@ -30,4 +30,28 @@ TEST_CASE("lexical_cast invalid conversions", "[lexical_cast]") {
 		REQUIRE_THROWS(scts::lexical_cast<int>("12.5124"));
 		REQUIRE_THROWS(scts::lexical_cast<float>("15121;sad"));
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("parse_number", "[lexical_cast]") {
+	SECTION("valid numbers") {
+		REQUIRE(scts::parse_number<int>("-124") == -124);
+		REQUIRE(scts::parse_number<std::uint8_t>("255") == 255);
+		REQUIRE(scts::parse_number<std::int8_t>("-128") == -128);
+		REQUIRE(scts::parse_number<float>("0.5") == 0.5f);
+		REQUIRE(scts::parse_number<double>("-1.5e3") == -1500.0);
+	}
+
+	SECTION("floating point numbers round trip exactly") {
+		REQUIRE(scts::parse_number<double>("0.1") == 0.1);
+		REQUIRE(scts::parse_number<double>("-35.23") == -35.23);
+		REQUIRE(scts::parse_number<float>("0.333333343") == 1.0f / 3.0f);
+	}
+
+	SECTION("invalid numbers and overflows throw") {
+		REQUIRE_THROWS_AS(scts::parse_number<int>("12.5124"), scts::invalid_lexical_cast);
+		REQUIRE_THROWS_AS(scts::parse_number<float>("15121;sad"), scts::invalid_lexical_cast);
+		REQUIRE_THROWS_AS(scts::parse_number<std::uint8_t>("256"), scts::invalid_lexical_cast);
+		REQUIRE_THROWS_AS(scts::parse_number<std::int32_t>("2147483648"), scts::invalid_lexical_cast);
+		REQUIRE_THROWS_AS(scts::parse_number<int>(""), scts::invalid_lexical_cast);
+	}
+}
@@ -0,0 +1,94 @@
+#include "catch.hpp"
+
+#include "test_objects.h"
+#include "test_helpers.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	// The bytes message_writer writes for a message.
+	template <typename O>
+	std::string frame_of(const O& object) {
+		scts::out_stream stream;
+		scts::serialize<O, scts::framed<scts::binary_formatter>>(object, stream);
+		return stream.str();
+	}
+}
+
+TEST_CASE("messages round trip through a pipe", "[message_stream]") {
+	test_pipe channel;
+	scts::message_writer writer(channel.writing());
+	std::vector<derived_object> written;
+	for (int i = 0; i < 10; ++i) {
+		written.push_back(derived_object{ i * 0.5, i, i * 0.25f, std::string(static_cast<std::size_t>(i), 'x') });
+		writer.write(written.back());
+	}
+	channel.close_writing();
+
+	scts::message_reader reader(channel.reading());
+	derived_object object;
+	for (const auto& expected : written) {
+		REQUIRE(reader.read(object));
+		REQUIRE(object == expected);
+	}
+	REQUIRE_FALSE(reader.read(object));
+}
+
+TEST_CASE("messages arriving in pieces are put back together", "[message_stream]") {
+	test_pipe channel;
+	const derived_object big{ 1.0, 2, 3.0f, std::string(200000, 'y') };
+	const derived_object small{ 4.0, 5, 6.0f, "small" };
+	const auto frames = frame_of(big) + frame_of(small);
+
+	std::thread sender([&] {
+		for (std::size_t i = 0; i < frames.size(); i += 7) {
+			scts::descriptor_io::write_all(channel.writing(), frames.data() + i, std::min<std::size_t>(7, frames.size() - i));
+		}
+		channel.close_writing();
+	});
+
+	scts::message_reader reader(channel.reading());
+	derived_object object;
+	REQUIRE(reader.read(object));
+	REQUIRE(object == big);
+	REQUIRE(reader.read(object));
+	REQUIRE(object == small);
+	REQUIRE_FALSE(reader.read(object));
+	sender.join();
+}
+
+TEST_CASE("reading resynchronizes on frame boundaries", "[message_stream]") {
+	test_pipe channel;
+	const derived_object first{ 1.0, 2, 3.0f, "first" };
+	const derived_object second{ 4.0, 5, 6.0f, "second" };
+	const derived_object third{ 7.0, 8, 9.0f, "third" };
+
+	auto damaged = frame_of(second);
+	damaged[scts::frame_layout::header_size + 2] ^= 0x01;
+	const auto input = std::string("garbage") + frame_of(first) + damaged + frame_of(third);
+	scts::descriptor_io::write_all(channel.writing(), input.data(), input.size());
+	channel.close_writing();
+
+	scts::message_reader reader(channel.reading());
+	derived_object object;
+	REQUIRE(reader.read(object));
+	REQUIRE(object == first);
+	REQUIRE(reader.skipped() == 7);
+	REQUIRE_THROWS_AS(reader.read(object), scts::checksum_mismatch);
+	REQUIRE(reader.read(object));
+	REQUIRE(object == third);
+	REQUIRE_FALSE(reader.read(object));
+}
+
+TEST_CASE("input ending within a message is an error", "[message_stream]") {
+	test_pipe channel;
+	const auto frame = frame_of(base_object{ 0.35, 12 });
+	scts::descriptor_io::write_all(channel.writing(), frame.data(), frame.size() - 3);
+	channel.close_writing();
+
+	scts::message_reader reader(channel.reading());
+	base_object object;
+	REQUIRE_THROWS_AS(reader.read(object), scts::unexpected_end_of_stream);
+}
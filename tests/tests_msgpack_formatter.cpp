@@ -0,0 +1,120 @@
+#include "catch.hpp"
+
+#include "test_objects.h"
+#include "test_helpers.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+	struct byte_buffers {
+		std::vector<std::uint8_t> bytes;
+		std::array<char, 3> tag;
+		std::vector<int> numbers;
+
+		bool operator==(const byte_buffers& other) const {
+			return bytes == other.bytes && tag == other.tag && numbers == other.numbers;
+		}
+	};
+}
+
+template <> struct scts::register_type<byte_buffers> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<byte_buffers,
+		scts::members<
+		scts::member<&byte_buffers::bytes>,
+		scts::member<&byte_buffers::tag>,
+		scts::member<&byte_buffers::numbers>>> descriptor{ "bytes", "tag", "numbers" };
+};
+
+TEST_CASE("msgpack_formatter supports all required types", "[msgpack_formatter]") {
+	complete_object a{
+		"cool{string[with]specialcharacters,",
+		true,
+		255,
+		state::moving,
+		nullptr,
+		{15.0f, -1.0f / 3.0f},
+		{base_object{1.0, -124}, base_object{-35.23, 0}},
+		{75.0, 98.0},
+		{{"key1", true}, {"key2", false}},
+		std::nullopt,
+		std::make_unique<int>(12)
+	};
+	const auto serialized = scts::serialize<complete_object, scts::msgpack_formatter>(a);
+	auto b = scts::deserialize<complete_object, scts::msgpack_formatter>(serialized.get_in_stream());
+	REQUIRE(a == b);
+
+	derived_object c{ -124.1, 76, 0.15f, "hello" };
+	derived_object d;
+	scts::deserialize<derived_object, scts::msgpack_formatter>(d, scts::serialize<derived_object, scts::msgpack_formatter>(c).get_in_stream());
+	REQUIRE(c == d);
+
+	mesh e{ { 1.0f, 2.0f, 3.0f }, { { 4.0f, 5.0f, 6.0f } } };
+	mesh f;
+	scts::deserialize<mesh, scts::msgpack_formatter>(f, scts::serialize<mesh, scts::msgpack_formatter>(e).get_in_stream());
+	REQUIRE(e == f);
+}
+
+TEST_CASE("msgpack_formatter uses the smallest encodings", "[msgpack_formatter]") {
+	const auto serialized = scts::serialize<base_object, scts::msgpack_formatter>(base_object{ 0.5, 3 }).str();
+	const auto expected = bytes_of({ 0xdf, 0, 0, 0, 2, 0xa4 }) + "data" + bytes_of({ 0xcb, 0x3f, 0xe0, 0, 0, 0, 0, 0, 0, 0xa7 }) + "integer" + bytes_of({ 3 });
+	REQUIRE(serialized == expected);
+
+	const auto negative = scts::serialize<base_object, scts::msgpack_formatter>(base_object{ 0.5, -3 }).str();
+	REQUIRE(negative.back() == static_cast<char>(0xfd));
+	const auto wide = scts::serialize<base_object, scts::msgpack_formatter>(base_object{ 0.5, -300 }).str();
+	REQUIRE(wide.substr(wide.size() - 3) == bytes_of({ 0xd1, 0xfe, 0xd4 }));
+
+	byte_buffers g{ { 1, 2, 3 }, { 'a', 'b', 'c' }, { 1, 200 } };
+	const auto buffers = scts::serialize<byte_buffers, scts::msgpack_formatter>(g).str();
+	REQUIRE(buffers.find(bytes_of({ 0xa5 }) + "bytes" + bytes_of({ 0xc4, 3, 1, 2, 3 })) != std::string::npos);
+	REQUIRE(buffers.find(bytes_of({ 0xa3 }) + "tag" + bytes_of({ 0xc4, 3 }) + "abc") != std::string::npos);
+	REQUIRE(buffers.find(bytes_of({ 0xa7 }) + "numbers" + bytes_of({ 0x92, 1, 0xcc, 200 })) != std::string::npos);
+	byte_buffers h;
+	scts::deserialize<byte_buffers, scts::msgpack_formatter>(h, buffers);
+	REQUIRE(g == h);
+
+	mesh e{ { 1.0f, 2.0f, 3.0f }, {} };
+	const auto nested = scts::serialize<mesh, scts::msgpack_formatter>(e).str();
+	REQUIRE(nested.find(bytes_of({ 0xa6 }) + "origin" + bytes_of({ 0x83, 0xa1 }) + "x" + bytes_of({ 0xca, 0x3f, 0x80, 0, 0 })) != std::string::npos);
+	REQUIRE(nested.substr(nested.size() - 10) == bytes_of({ 0xa8 }) + "vertices" + bytes_of({ 0x90 }));
+}
+
+TEST_CASE("msgpack_formatter writes nil for missing values", "[msgpack_formatter]") {
+	complete_object a{ "", false, 0, state::idle, nullptr, {}, {}, {}, {}, std::nullopt, nullptr };
+	const auto serialized = scts::serialize<complete_object, scts::msgpack_formatter>(a).str();
+	REQUIRE(serialized.find(bytes_of({ 0xa7 }) + "pointer" + bytes_of({ 0xc0 })) != std::string::npos);
+	REQUIRE(serialized.find(bytes_of({ 0xb0 }) + "optional_of_enum" + bytes_of({ 0xc0 })) != std::string::npos);
+	REQUIRE(serialized.substr(serialized.size() - 11) == bytes_of({ 0xa9 }) + "smart_ptr" + bytes_of({ 0xc0 }));
+
+	complete_object b{ "", false, 0, state::idle, nullptr, {}, {}, {}, {}, state::moving, std::make_unique<int>(1) };
+	scts::deserialize<complete_object, scts::msgpack_formatter>(b, serialized);
+	REQUIRE(!b.optional_of_enum.has_value());
+	REQUIRE(b.smart_ptr == nullptr);
+}
+
+TEST_CASE("msgpack_formatter reads input from other encoders", "[msgpack_formatter]") {
+	// A fixmap with an unknown key holding nested values and an extension, and numbers in wider encodings than needed.
+	const auto input = bytes_of({ 0x83, 0xa7 }) + "unknown" + bytes_of({ 0x92, 0x81, 0xa1, 'k', 0xd6, 1, 0, 0, 0, 0, 0xc7, 2, 5, 0, 0 })
+		+ bytes_of({ 0xa7 }) + "integer" + bytes_of({ 0xd2, 0xff, 0xff, 0xff, 0xfe })
+		+ bytes_of({ 0xa4 }) + "data" + bytes_of({ 0xcd, 1, 0 });
+	base_object a{};
+	scts::deserialize<base_object, scts::msgpack_formatter>(a, input);
+	REQUIRE(a == base_object{ 256.0, -2 });
+}
+
+TEST_CASE("msgpack_formatter rejects invalid input", "[msgpack_formatter]") {
+	base_object a{};
+	const auto too_large = bytes_of({ 0x81, 0xa7 }) + "integer" + bytes_of({ 0xcf, 1, 0, 0, 0, 0, 0, 0, 0 });
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::msgpack_formatter>(a, too_large)), scts::invalid_msgpack);
+	const auto not_a_map = bytes_of({ 0x91, 1 });
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::msgpack_formatter>(a, not_a_map)), scts::invalid_msgpack);
+	const auto wrong_type = bytes_of({ 0x81, 0xa4 }) + "data" + bytes_of({ 0xa1 }) + "x";
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::msgpack_formatter>(a, wrong_type)), scts::invalid_msgpack);
+	const auto truncated = bytes_of({ 0x81, 0xa4 }) + "data" + bytes_of({ 0xcb, 0x3f });
+	REQUIRE_THROWS_AS((scts::deserialize<base_object, scts::msgpack_formatter>(a, truncated)), scts::unexpected_end_of_stream);
+
+	byte_buffers b{};
+	const auto wrong_size = bytes_of({ 0x81, 0xa3 }) + "tag" + bytes_of({ 0xc4, 2 }) + "ab";
+	REQUIRE_THROWS_AS((scts::deserialize<byte_buffers, scts::msgpack_formatter>(b, wrong_size)), scts::invalid_msgpack);
+}
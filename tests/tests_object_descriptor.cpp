@@ -13,4 +13,74 @@ template <> struct scts::register_type<simple_test_object> : scts::allow_seriali
 
 TEST_CASE("object descriptor basics", "[object_descriptor]") {
 	STATIC_REQUIRE(scts::register_type<simple_test_object>::descriptor.has_names);
-}
\ No newline at end of file
+}
+
+TEST_CASE("name lookup", "[object_descriptor]") {
+	static constexpr std::array<std::string_view, 4> names{ "data", "integer", "floating", "string" };
+	static constexpr scts::name_lookup<names.size()> lookup{ names };
+
+	STATIC_REQUIRE(lookup.find("data") == 0);
+	STATIC_REQUIRE(lookup.find("string") == 3);
+	STATIC_REQUIRE(lookup.find("strin") == scts::name_lookup<names.size()>::npos);
+	STATIC_REQUIRE(lookup.find("") == scts::name_lookup<names.size()>::npos);
+}
+
+// An object with 513 members, to make sure that descriptors don't instantiate templates per member recursively.
+#define SCTS_TEST_COLUMNS(X, prefix) X(prefix##0) X(prefix##1) X(prefix##2) X(prefix##3) X(prefix##4) X(prefix##5) X(prefix##6) X(prefix##7) \
+	X(prefix##8) X(prefix##9) X(prefix##a) X(prefix##b) X(prefix##c) X(prefix##d) X(prefix##e) X(prefix##f)
+#define SCTS_TEST_ROWS(X, prefix) SCTS_TEST_COLUMNS(X, prefix##0) SCTS_TEST_COLUMNS(X, prefix##1) SCTS_TEST_COLUMNS(X, prefix##2) \
+	SCTS_TEST_COLUMNS(X, prefix##3) SCTS_TEST_COLUMNS(X, prefix##4) SCTS_TEST_COLUMNS(X, prefix##5) SCTS_TEST_COLUMNS(X, prefix##6) \
+	SCTS_TEST_COLUMNS(X, prefix##7) SCTS_TEST_COLUMNS(X, prefix##8) SCTS_TEST_COLUMNS(X, prefix##9) SCTS_TEST_COLUMNS(X, prefix##a) \
+	SCTS_TEST_COLUMNS(X, prefix##b) SCTS_TEST_COLUMNS(X, prefix##c) SCTS_TEST_COLUMNS(X, prefix##d) SCTS_TEST_COLUMNS(X, prefix##e) \
+	SCTS_TEST_COLUMNS(X, prefix##f)
+#define SCTS_TEST_ALL(X) SCTS_TEST_ROWS(X, m) SCTS_TEST_ROWS(X, n)
+
+#define SCTS_TEST_FIELD(name) int name = 0;
+#define SCTS_TEST_MEMBER(name) scts::member<&wide_test_object::name>,
+#define SCTS_TEST_NAME(name) #name,
+
+struct wide_test_object {
+	SCTS_TEST_ALL(SCTS_TEST_FIELD)
+	int last = 0;
+};
+
+template <> struct scts::register_type<wide_test_object> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<wide_test_object,
+		scts::members<SCTS_TEST_ALL(SCTS_TEST_MEMBER) scts::member<&wide_test_object::last>>> descriptor{ SCTS_TEST_ALL(SCTS_TEST_NAME) "last" };
+};
+
+#undef SCTS_TEST_NAME
+#undef SCTS_TEST_MEMBER
+#undef SCTS_TEST_FIELD
+#undef SCTS_TEST_ALL
+#undef SCTS_TEST_ROWS
+#undef SCTS_TEST_COLUMNS
+
+TEST_CASE("objects with hundreds of members", "[object_descriptor]") {
+	STATIC_REQUIRE(scts::register_type<wide_test_object>::descriptor.member_count == 513);
+
+	wide_test_object object;
+	object.m00 = 1;
+	object.m7f = 2;
+	object.mff = 3;
+	object.n80 = 5;
+	object.nff = 6;
+	object.last = 4;
+
+	const auto json = scts::serialize(object);
+	REQUIRE(json.view().substr(0, 16) == "{\"m00\":1,\"m01\":0");
+	REQUIRE(json.view().substr(json.size() - 17) == "\"nff\":6,\"last\":4}");
+	const auto from_json = scts::deserialize<wide_test_object>(json.view());
+	REQUIRE(from_json.m00 == 1);
+	REQUIRE(from_json.m7f == 2);
+	REQUIRE(from_json.mff == 3);
+	REQUIRE(from_json.n80 == 5);
+	REQUIRE(from_json.nff == 6);
+	REQUIRE(from_json.last == 4);
+
+	const auto binary = scts::serialize(object, scts::binary_formatter());
+	const auto from_binary = scts::deserialize<wide_test_object>(binary.view(), scts::binary_formatter());
+	REQUIRE(from_binary.m7f == 2);
+	REQUIRE(from_binary.nff == 6);
+	REQUIRE(from_binary.last == 4);
+}
@@ -0,0 +1,243 @@
+#include "catch.hpp"
+
+#include "test_objects.h"
+#include "test_helpers.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <optional>
+
+namespace {
+	// The examples of the protobuf encoding documentation.
+	struct test1 {
+		int32_t a;
+
+		bool operator==(const test1& other) const {
+			return a == other.a;
+		}
+	};
+
+	struct wire_example {
+		int32_t a;
+		std::string b;
+		test1 c;
+		std::vector<int32_t> d;
+	};
+
+	struct record {
+		std::string name;
+		int64_t id;
+		std::vector<std::string> tags;
+		std::vector<test1> children;
+		std::optional<double> ratio;
+		state kind;
+		std::map<std::string, int32_t> counters;
+		std::array<float, 2> range;
+		std::unique_ptr<test1> origin;
+		std::vector<std::uint8_t> payload;
+		bool flag;
+		std::vector<double> weights;
+
+		bool operator==(const record& other) const {
+			return name == other.name && id == other.id && tags == other.tags && children == other.children &&
+				ratio == other.ratio && kind == other.kind && counters == other.counters && range == other.range &&
+				(origin == nullptr) == (other.origin == nullptr) && (origin == nullptr || *origin == *other.origin) &&
+				payload == other.payload && flag == other.flag && weights == other.weights;
+		}
+	};
+
+	struct numbered_base {
+		uint32_t version;
+	};
+
+	struct numbered_derived : numbered_base {
+		std::string label;
+	};
+
+	struct linked {
+		int32_t value;
+		test1* next;
+	};
+
+	// Field numbers too far apart for a direct table.
+	struct sparse {
+		int32_t low;
+		int32_t high;
+		int32_t highest;
+	};
+}
+
+template <> struct scts::register_type<test1> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<test1,
+		scts::members<scts::member<&test1::a, 1>>> descriptor{ "a" };
+};
+
+template <> struct scts::register_type<wire_example> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<wire_example,
+		scts::members<
+		scts::member<&wire_example::a, 1>,
+		scts::member<&wire_example::b, 2>,
+		scts::member<&wire_example::c, 3>,
+		scts::member<&wire_example::d, 4>>> descriptor{ "a", "b", "c", "d" };
+};
+
+template <> struct scts::register_type<record> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<record,
+		scts::members<
+		scts::member<&record::name, 1>,
+		scts::member<&record::id, 2>,
+		scts::member<&record::tags, 3>,
+		scts::member<&record::children, 4>,
+		scts::member<&record::ratio, 5>,
+		scts::member<&record::kind, 6>,
+		scts::member<&record::counters, 7>,
+		scts::member<&record::range, 8>,
+		scts::member<&record::origin, 9>,
+		scts::member<&record::payload, 10>,
+		scts::member<&record::flag, 11>,
+		scts::member<&record::weights, 12>>> descriptor{};
+};
+
+template <> struct scts::register_type<numbered_base> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<numbered_base,
+		scts::members<scts::member<&numbered_base::version, 1>>> descriptor{};
+};
+
+template <> struct scts::register_type<numbered_derived> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<numbered_derived,
+		scts::members<scts::member<&numbered_derived::label, 2>>,
+		scts::inherits_from<numbered_base>> descriptor{};
+};
+
+template <> struct scts::register_type<linked> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<linked,
+		scts::members<
+		scts::member<&linked::value, 1>,
+		scts::member<&linked::next, 2>>> descriptor{};
+};
+
+template <> struct scts::register_type<sparse> : scts::allow_serialization {
+	static constexpr scts::object_descriptor<sparse,
+		scts::members<
+		scts::member<&sparse::high, 1000>,
+		scts::member<&sparse::low, 1>,
+		scts::member<&sparse::highest, scts::protobuf_wire::max_field_number>>> descriptor{};
+};
+
+TEST_CASE("protobuf_formatter writes the documented wire format", "[protobuf_formatter]") {
+	const wire_example a{ 150, "testing", { 150 }, { 3, 270, 86942 } };
+	const auto serialized = scts::serialize<wire_example, scts::protobuf_formatter>(a).str();
+	const auto expected = bytes_of({ 0x08, 0x96, 0x01, 0x12, 0x07 }) + "testing" + bytes_of({ 0x1a, 0x03, 0x08, 0x96, 0x01 })
+		+ bytes_of({ 0x22, 0x06, 0x03, 0x8e, 0x02, 0x9e, 0xa7, 0x05 });
+	REQUIRE(serialized == expected);
+
+	wire_example b{};
+	scts::deserialize<wire_example, scts::protobuf_formatter>(b, serialized);
+	REQUIRE(b.a == 150);
+	REQUIRE(b.b == "testing");
+	REQUIRE(b.c.a == 150);
+	REQUIRE(b.d == a.d);
+
+	// Defaults are left out, and negative numbers take ten bytes.
+	REQUIRE(scts::serialize<test1, scts::protobuf_formatter>(test1{ 0 }).str().empty());
+	REQUIRE(scts::serialize<test1, scts::protobuf_formatter>(test1{ -1 }).str() == bytes_of({ 0x08, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 }));
+}
+
+TEST_CASE("protobuf_formatter supports all required types", "[protobuf_formatter]") {
+	record a{ "name", -5, { "x", "", "z" }, { { 1 }, { 0 } }, 0.0, state::moving, { { "one", 1 }, { "zero", 0 } },
+		{ 0.5f, -1.0f }, std::make_unique<test1>(test1{ 7 }), { 0, 1, 255 }, true, { 0.25, 1e300 } };
+	const auto serialized = scts::serialize<record, scts::protobuf_formatter>(a);
+	record b{};
+	scts::deserialize<record, scts::protobuf_formatter>(b, serialized.get_in_stream());
+	REQUIRE(a == b);
+	REQUIRE(b.children[0].a == 1);
+	REQUIRE(b.children[1].a == 0);
+	REQUIRE(b.ratio.has_value());
+
+	constexpr auto field_numbers = scts::register_type<numbered_derived>::descriptor.field_numbers();
+	STATIC_REQUIRE(field_numbers.size() == 2);
+	STATIC_REQUIRE(field_numbers[0] == 1);
+	STATIC_REQUIRE(field_numbers[1] == 2);
+	numbered_derived c;
+	c.version = 3;
+	c.label = "derived";
+	numbered_derived d;
+	scts::deserialize<numbered_derived, scts::protobuf_formatter>(d, scts::serialize<numbered_derived, scts::protobuf_formatter>(c).get_in_stream());
+	REQUIRE(d.version == 3);
+	REQUIRE(d.label == "derived");
+}
+
+TEST_CASE("protobuf_formatter resets fields missing from the input", "[protobuf_formatter]") {
+	record a{ "stale", 9, { "x" }, { { 1 } }, 1.5, state::moving, { { "one", 1 } }, { 1.0f, 2.0f }, std::make_unique<test1>(test1{ 7 }), { 1 }, true, { 1.0 } };
+	scts::deserialize<record, scts::protobuf_formatter>(a, bytes_of({ 0x10, 0x02 }));
+	record expected{};
+	expected.id = 2;
+	REQUIRE(a == expected);
+
+	// Raw pointers are owned by the caller, so they are left alone when missing, and read into or allocated when present.
+	test1 owned{ 5 };
+	linked b{ 1, &owned };
+	scts::deserialize<linked, scts::protobuf_formatter>(b, bytes_of({ 0x08, 0x02 }));
+	REQUIRE(b.value == 2);
+	REQUIRE(b.next == &owned);
+
+	linked c{};
+	scts::deserialize<linked, scts::protobuf_formatter>(c, scts::serialize<linked, scts::protobuf_formatter>(linked{ 3, &owned }).get_in_stream());
+	REQUIRE(c.value == 3);
+	REQUIRE(c.next != nullptr);
+	REQUIRE(c.next->a == 5);
+	delete c.next;
+}
+
+TEST_CASE("protobuf_formatter reads input from other encoders", "[protobuf_formatter]") {
+	// Unknown fields of every wire type including a group, unpacked repeated numbers, a field repeated and a message merged.
+	const auto input = bytes_of({ 0xa8, 0x1f, 0x96, 0x01 })
+		+ bytes_of({ 0xb1, 0x1f, 1, 2, 3, 4, 5, 6, 7, 8 })
+		+ bytes_of({ 0xba, 0x1f, 0x02, 0x08, 0x01 })
+		+ bytes_of({ 0xc5, 0x1f, 1, 2, 3, 4 })
+		+ bytes_of({ 0xcb, 0x1f, 0x08, 0x01, 0xd3, 0x1f, 0xd4, 0x1f, 0xcc, 0x1f })
+		+ bytes_of({ 0x08, 0x01, 0x12, 0x01 }) + "b"
+		+ bytes_of({ 0x20, 0x03, 0x20, 0x04, 0x22, 0x01, 0x05 })
+		+ bytes_of({ 0x1a, 0x02, 0x08, 0x05 }) + bytes_of({ 0x08, 0x02 });
+	wire_example a{ 9, "stale", { 9 }, { 9 } };
+	scts::deserialize<wire_example, scts::protobuf_formatter>(a, input);
+	REQUIRE(a.a == 2);
+	REQUIRE(a.b == "b");
+	REQUIRE(a.c.a == 5);
+	REQUIRE(a.d == std::vector<int32_t>{ 3, 4, 5 });
+
+	sparse b{ 1, 2, 3 };
+	const auto serialized = scts::serialize<sparse, scts::protobuf_formatter>(b).str();
+	REQUIRE(serialized.substr(0, 3) == bytes_of({ 0xc0, 0x3e, 0x02 }));
+	sparse c{};
+	scts::deserialize<sparse, scts::protobuf_formatter>(c, serialized);
+	REQUIRE((c.low == 1 && c.high == 2 && c.highest == 3));
+
+	// A message field repeated behind a raw pointer is allocated once and merged into.
+	linked d{};
+	scts::deserialize<linked, scts::protobuf_formatter>(d, bytes_of({ 0x12, 0x02, 0x08, 0x05, 0x12, 0x02, 0x08, 0x06 }));
+	REQUIRE(d.next != nullptr);
+	REQUIRE(d.next->a == 6);
+	delete d.next;
+
+	REQUIRE(scts::field_lookup<3, 1, 7>::find(7) == 2);
+	REQUIRE(scts::field_lookup<3, 1, 7>::find(2) == scts::field_lookup<3, 1, 7>::npos);
+	REQUIRE(scts::field_lookup<5, 100000, 9>::find(100000) == 1);
+	REQUIRE(scts::field_lookup<5, 100000, 9>::find(6) == scts::field_lookup<5, 100000, 9>::npos);
+}
+
+TEST_CASE("protobuf_formatter rejects invalid input", "[protobuf_formatter]") {
+	test1 a{};
+	REQUIRE_THROWS_AS((scts::deserialize<test1, scts::protobuf_formatter>(a, bytes_of({ 0x0d, 0, 0, 0, 0 }))), scts::invalid_protobuf);
+	REQUIRE_THROWS_AS((scts::deserialize<test1, scts::protobuf_formatter>(a, bytes_of({ 0x00, 0x01 }))), scts::invalid_protobuf);
+	REQUIRE_THROWS_AS((scts::deserialize<test1, scts::protobuf_formatter>(a, bytes_of({ 0x08, 0x80, 0x80, 0x80, 0x80, 0x10 }))), scts::invalid_protobuf);
+	REQUIRE_THROWS_AS((scts::deserialize<test1, scts::protobuf_formatter>(a, bytes_of({ 0x13, 0x08, 0x01, 0x1c }))), scts::invalid_protobuf);
+	REQUIRE_THROWS_AS((scts::deserialize<test1, scts::protobuf_formatter>(a, bytes_of({ 0x16, 0x08, 0x01 }))), scts::invalid_protobuf);
+	REQUIRE_THROWS_AS((scts::deserialize<test1, scts::protobuf_formatter>(a, bytes_of({ 0x12, 0x05, 0x01 }))), scts::unexpected_end_of_stream);
+	REQUIRE_THROWS_AS((scts::deserialize<test1, scts::protobuf_formatter>(a, bytes_of({ 0x08, 0x96 }))), scts::unexpected_end_of_stream);
+
+	record b{};
+	const auto wrong_count = bytes_of({ 0x42, 0x04, 0, 0, 0, 0 });
+	REQUIRE_THROWS_AS((scts::deserialize<record, scts::protobuf_formatter>(b, wrong_count)), scts::invalid_protobuf);
+}
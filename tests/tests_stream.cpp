@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include "../scts/stream.h"
+
+#include <limits>
+#include <cstdint>
+#include <cstring>
+
+TEST_CASE("byte_buffer basics", "[stream]") {
+	scts::byte_buffer buffer;
+	REQUIRE(buffer.empty());
+
+	SECTION("appending") {
+		buffer.append("abc", 3);
+		buffer << 'd' << std::string_view("ef");
+		REQUIRE(buffer.size() == 6);
+		REQUIRE(buffer.view() == "abcdef");
+		REQUIRE(buffer.str() == "abcdef");
+	}
+
+	SECTION("capacity control") {
+		buffer.reserve(1024);
+		REQUIRE(buffer.capacity() >= 1024);
+		const auto data = buffer.data();
+		for (int i = 0; i < 1024; ++i) buffer << 'x';
+		REQUIRE(buffer.data() == data);
+		buffer.clear();
+		REQUIRE(buffer.empty());
+		REQUIRE(buffer.capacity() >= 1024);
+	}
+
+	SECTION("numbers are written as text") {
+		buffer << 12 << ' ' << -3.5 << ' ' << 10.5f;
+		REQUIRE(buffer.view() == "12 -3.5 10.5");
+	}
+
+	SECTION("integers are written exactly") {
+		buffer << 0 << ' ' << -7 << ' ' << 100 << ' ' << std::numeric_limits<std::int64_t>::min() << ' ' << std::numeric_limits<std::uint64_t>::max();
+		REQUIRE(buffer.view() == "0 -7 100 -9223372036854775808 18446744073709551615");
+	}
+
+	SECTION("floating point numbers use the shortest representation that round trips") {
+		buffer << 0.1 << ' ' << 1.0f / 3.0f << ' ' << -124.1 << ' ' << 1e300;
+		REQUIRE(buffer.view() == "0.1 0.33333334 -124.1 1e+300");
+	}
+
+	SECTION("writing directly into the buffer") {
+		const auto begin = buffer.prepare(8);
+		std::memcpy(begin, "direct", 6);
+		buffer.commit(6);
+		REQUIRE(buffer.view() == "direct");
+	}
+
+	SECTION("copies are independent") {
+		buffer << "hello";
+		auto copy = buffer;
+		copy << " world";
+		REQUIRE(buffer.view() == "hello");
+		REQUIRE(copy.view() == "hello world");
+	}
+}
+
+TEST_CASE("in_stream reads without consuming the data", "[stream]") {
+	const std::string data = "abcdef";
+	scts::in_stream stream{ data };
+	REQUIRE(stream.size() == 6);
+
+	REQUIRE(stream.get() == 'a');
+	REQUIRE(stream.peek() == 'b');
+	REQUIRE(stream.read(3) == "bcd");
+	REQUIRE(stream.position() == 4);
+	REQUIRE(stream.rest() == "ef");
+	REQUIRE(stream.data() == data);
+
+	stream.advance(2);
+	REQUIRE(stream.empty());
+	REQUIRE_THROWS_AS(stream.get(), scts::unexpected_end_of_stream);
+
+	stream.seek(0);
+	REQUIRE(stream.remaining() == 6);
+}
+
+TEST_CASE("byte_buffer can be read back without copying", "[stream]") {
+	scts::byte_buffer buffer;
+	buffer << "serialized";
+	const auto stream = buffer.get_in_stream();
+	REQUIRE(stream.data().data() == buffer.data());
+	REQUIRE(stream.rest() == "serialized");
+}